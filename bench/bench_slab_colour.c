@@ -0,0 +1,94 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+/*
+ * Walk the first cache line of every element of a pool of 4 KiB elements,
+ * as a batch of objects touched together would be. Without colouring, every
+ * element header maps to the same cache set and the walk thrashes the set.
+ */
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mm/slab.h>
+
+/* --------------------------------------------------------------------------
+ * LOCAL CONSTANTS
+ * -------------------------------------------------------------------------- */
+
+#define BENCH_ESIZE 4096
+#define BENCH_ECOUNT 64
+#define BENCH_ROUNDS 200000
+
+/* --------------------------------------------------------------------------
+ * LOCAL FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+static uint64_t _now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static double _walk(unsigned int flags)
+{
+	struct mm_slab_config config = {
+		.alignment = 64,
+		.esize = BENCH_ESIZE,
+		.ecount = BENCH_ECOUNT,
+		.flags = flags,
+	};
+	void *objs[BENCH_ECOUNT];
+	volatile uint64_t sum = 0;
+	struct mm_slab *slab;
+	uint64_t start, stop;
+	int i, round;
+
+	slab = mm_slab_create_config(&config);
+	if (!slab || mm_slab_alloc_bulk(slab, objs, BENCH_ECOUNT) != BENCH_ECOUNT) {
+		fprintf(stderr, "cannot create the benchmark pool\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < BENCH_ECOUNT; i++)
+		*(uint64_t *)objs[i] = i;
+
+	start = _now_ns();
+	for (round = 0; round < BENCH_ROUNDS; round++)
+		for (i = 0; i < BENCH_ECOUNT; i++)
+			sum += *(volatile uint64_t *)objs[i];
+	stop = _now_ns();
+
+	mm_slab_free_bulk(slab, objs, BENCH_ECOUNT);
+	mm_slab_destroy(slab);
+
+	return (double)(stop - start) / ((double)BENCH_ROUNDS * BENCH_ECOUNT);
+}
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+int main(void)
+{
+	double plain, coloured;
+
+	plain = _walk(0);
+	coloured = _walk(MM_SLAB_F_COLOUR);
+
+	printf("%d elements of %d bytes\n", BENCH_ECOUNT, BENCH_ESIZE);
+	printf("  plain:    %.2f ns/access\n", plain);
+	printf("  coloured: %.2f ns/access\n", coloured);
+	printf("  speedup:  %.2fx\n", plain / coloured);
+
+	return 0;
+}
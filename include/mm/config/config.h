@@ -14,6 +14,76 @@ extern "C" {
 #define MM_ALIGN 32
 #endif /* !MM_ALIGN */
 
+#ifndef MM_CACHELINE_SIZE
+/**
+ * @def MM_CACHELINE_SIZE
+ * @brief Size of a data cache line, used as the slab colour step
+ */
+#define MM_CACHELINE_SIZE 64
+#endif /* !MM_CACHELINE_SIZE */
+
+#ifndef MM_COLOUR_SPAN
+/**
+ * @def MM_COLOUR_SPAN
+ * @brief Distance between two addresses sharing the same cache set (size of
+ *        one cache way). Slab colour offsets cycle within this span.
+ */
+#define MM_COLOUR_SPAN 4096
+#endif /* !MM_COLOUR_SPAN */
+
+#ifndef MM_PAGE_SIZE
+/**
+ * @def MM_PAGE_SIZE
+ * @brief Page size used when the system cannot be queried
+ */
+#define MM_PAGE_SIZE 4096
+#endif /* !MM_PAGE_SIZE */
+
+#ifndef MM_HUGEPAGE_SIZE
+/**
+ * @def MM_HUGEPAGE_SIZE
+ * @brief Size of a huge page, mappings asking for huge pages are rounded up
+ *        and aligned to this size
+ */
+#define MM_HUGEPAGE_SIZE (2 * 1024 * 1024)
+#endif /* !MM_HUGEPAGE_SIZE */
+
+#ifndef MM_SLAB_STORAGE_SIZE
+/**
+ * @def MM_SLAB_STORAGE_SIZE
+ * @brief Size of struct mm_slab_storage, must hold a slab descriptor (checked
+ *        at build time, depends on MUTEX_TYPE)
+ */
+#define MM_SLAB_STORAGE_SIZE 512
+#endif /* !MM_SLAB_STORAGE_SIZE */
+
+#ifndef MM_SLAB_ARENA_SMALL
+/**
+ * @def MM_SLAB_ARENA_SMALL
+ * @brief Largest size looked up with an 8-byte granularity by the slab arena,
+ *        larger sizes are looked up by power of two and quarter of it
+ */
+#define MM_SLAB_ARENA_SMALL 1024
+#endif /* !MM_SLAB_ARENA_SMALL */
+
+#ifndef MM_SLAB_ARENA_SLABS
+/**
+ * @def MM_SLAB_ARENA_SLABS
+ * @brief Largest number of slab pools backing a size class of an adaptive
+ *        slab arena, see mm_slab_arena_adapt()
+ */
+#define MM_SLAB_ARENA_SLABS 8
+#endif /* !MM_SLAB_ARENA_SLABS */
+
+#ifndef MM_CGROUP_PATH
+/**
+ * @def MM_CGROUP_PATH
+ * @brief Directory of the cgroup (v2) whose memory usage is watched by the
+ *        shrinkers, see mm_shrinker_set_cgroup()
+ */
+#define MM_CGROUP_PATH "/sys/fs/cgroup"
+#endif /* !MM_CGROUP_PATH */
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -19,6 +19,14 @@ extern "C" {
 #define MUTEX_TYPE pthread_mutex_t
 #endif /* !MUTEX_TYPE */
 
+#ifndef MUTEX_INITIALIZER
+/**
+ * @def MUTEX_INITIALIZER
+ * @brief Static initialiser of a mutex, if not available, should be set to {0}
+ */
+#define MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#endif /* !MUTEX_INITIALIZER */
+
 #ifndef MUTEX_INIT
 /**
  * @def MUTEX_INIT(mutex)
@@ -27,6 +27,26 @@ extern "C" {
 #define THREAD_KEY_CREATE(key, destructor) pthread_key_create((pthread_key_t *)key, destructor)
 #endif /* !THREAD_KEY_CREATE */
 
+#ifndef THREAD_KEY_TYPE
+#define THREAD_KEY_TYPE pthread_key_t
+#endif /* !THREAD_KEY_TYPE */
+
+#ifndef THREAD_KEY_DELETE
+#define THREAD_KEY_DELETE(key) pthread_key_delete(key)
+#endif /* !THREAD_KEY_DELETE */
+
+#ifndef THREAD_TYPE
+#define THREAD_TYPE pthread_t
+#endif /* !THREAD_TYPE */
+
+#ifndef THREAD_CREATE
+#define THREAD_CREATE(thread, fn, arg) pthread_create(&thread, NULL, fn, arg)
+#endif /* !THREAD_CREATE */
+
+#ifndef THREAD_JOIN
+#define THREAD_JOIN(thread) pthread_join(thread, NULL)
+#endif /* !THREAD_JOIN */
+
 #ifndef THREAD_GET_NAME_MAXLEN
 #define THREAD_GET_NAME_MAXLEN 16
 #endif /* !THREAD_GET_NAME_MAXLEN */
@@ -0,0 +1,85 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#pragma once
+
+/**
+ * @ingroup mm_components
+ */
+
+/**
+ * NUMA placement of page-mapped regions.
+ *
+ * A policy is applied on a region before its pages are touched, so that the
+ * kernel places them on the requested node(s). On systems without NUMA support
+ * (or with a single node) every policy degrades to the default placement and
+ * node 0 is reported as the only node.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <stddef.h>
+
+/* --------------------------------------------------------------------------
+ * PUBLIC TYPES
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief NUMA placement policies
+ */
+enum mm_numa_policy {
+	MM_NUMA_DEFAULT = 0, /*!< No policy, first touch placement */
+	MM_NUMA_LOCAL, /*!< Node of the thread applying the policy */
+	MM_NUMA_NODE, /*!< Explicit node */
+	MM_NUMA_INTERLEAVE, /*!< Pages interleaved over every online node */
+};
+
+/**
+ * @brief NUMA placement of a region
+ */
+struct mm_numa {
+	enum mm_numa_policy policy; /*!< Placement policy */
+	int node; /*!< Node used by #MM_NUMA_NODE */
+};
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Get the number of online NUMA nodes
+ *
+ * The online nodes are read once, on the first call of a NUMA function.
+ *
+ * @return the number of nodes, at least 1
+ */
+int mm_numa_node_count(void);
+
+/**
+ * @brief Get the node of the CPU the calling thread runs on
+ *
+ * @return the node, 0 if unknown
+ */
+int mm_numa_current_node(void);
+
+/**
+ * @brief Apply a NUMA policy on a page-aligned region
+ *
+ * @param[in] addr The region, page-aligned
+ * @param[in] size The size of the region
+ * @param[in] numa The policy to apply, nothing is done if NULL
+ *
+ * @return 0 if successful (or degraded to the default placement), -EINVAL if
+ *         the node is past the supported ones, a negative value otherwise
+ */
+int mm_numa_apply(void *addr, size_t size, const struct mm_numa *numa);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
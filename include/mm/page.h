@@ -0,0 +1,222 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#pragma once
+
+/**
+ * @ingroup mm_components
+ */
+
+/**
+ * A page provider hands out page-aligned memory regions directly from the
+ * system, bypassing the heap. Slab pools created with #MM_SLAB_F_PAGES or
+ * #MM_SLAB_F_HUGEPAGE take their memory from a page provider.
+ *
+ * The default provider maps anonymous memory. When huge pages are requested it
+ * first tries explicit huge pages (MAP_HUGETLB), then transparent huge pages on
+ * a huge-page aligned mapping (madvise(MADV_HUGEPAGE)), then falls back to
+ * regular pages. On targets without mmap() it falls back to page-aligned heap
+ * memory.
+ *
+ * A target can plug its own page allocator by filling a struct mm_page_provider
+ * and giving it to struct mm_slab_config.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <stddef.h>
+#include <sys/types.h>
+
+/* --------------------------------------------------------------------------
+ * PUBLIC CONSTANTS
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @def MM_PAGE_F_HUGE
+ * @brief Back the region with huge pages when possible
+ */
+#define MM_PAGE_F_HUGE (1u << 0)
+
+/* --------------------------------------------------------------------------
+ * PUBLIC TYPES
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Page provider operations
+ */
+struct mm_page_provider {
+	/**
+	 * @brief Map a region of at least @a *size bytes
+	 *
+	 * @param[in] ctx The provider context
+	 * @param[in,out] size The requested size, updated with the mapped size
+	 * @param[in] flags MM_PAGE_F_* flags
+	 *
+	 * @return the page-aligned region, NULL otherwise
+	 */
+	void *(*map)(void *ctx, size_t *size, unsigned int flags);
+
+	/**
+	 * @brief Unmap a region returned by @a map
+	 *
+	 * @param[in] ctx The provider context
+	 * @param[in] addr The region
+	 * @param[in] size The size returned by @a map
+	 */
+	void (*unmap)(void *ctx, void *addr, size_t size);
+
+	/**
+	 * @brief Give the memory of a page-aligned part of a mapped region back
+	 *        to the system, the region stays mapped and reads as zero (optional)
+	 *
+	 * @param[in] ctx The provider context
+	 * @param[in] addr The start of the part, page-aligned
+	 * @param[in] size The size of the part, a multiple of the page size
+	 *
+	 * @return 0 if successful, a negative value otherwise
+	 */
+	int (*release)(void *ctx, void *addr, size_t size);
+
+	void *ctx; /*!< Provider context */
+};
+
+/* --------------------------------------------------------------------------
+ * PUBLIC VARIABLES
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief The default page provider
+ */
+extern const struct mm_page_provider mm_page_provider_default;
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Get the size of a page
+ *
+ * @return the page size in bytes
+ */
+size_t mm_page_size(void);
+
+/**
+ * @brief Map a region from the default page provider
+ *
+ * @param[in,out] size The requested size, updated with the mapped size
+ * @param[in] flags MM_PAGE_F_* flags
+ *
+ * @return the page-aligned region, NULL otherwise
+ */
+void *mm_page_map(size_t *size, unsigned int flags);
+
+/**
+ * @brief Unmap a region returned by mm_page_map()
+ *
+ * @param[in] addr The region
+ * @param[in] size The size returned by mm_page_map()
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+int mm_page_unmap(void *addr, size_t size);
+
+/**
+ * @brief Reserve a region of address space without memory
+ * The region is inaccessible until parts of it are given memory with
+ * mm_page_commit(). It is released with mm_page_unmap().
+ * @param[in,out] size The requested size, updated with the reserved size
+ * @param[in] align The alignment of the region, a power of two (at least a page)
+ * @param[in] flags MM_PAGE_F_* flags, MM_PAGE_F_HUGE asks for transparent huge
+ *                  pages once committed
+ * @return the page-aligned region, NULL otherwise (always without mmap())
+ */
+void *mm_page_reserve(size_t *size, size_t align, unsigned int flags);
+
+/**
+ * @brief Make pages of a region reserved by mm_page_reserve() accessible
+ * Memory is only taken by the pages as they are first touched.
+ * @param[in] addr The first page, page-aligned
+ * @param[in] size The size, a multiple of the page size
+ * @return 0 if successful, a negative value otherwise (-ENOTSUP without
+ *         system support)
+ */
+int mm_page_commit(void *addr, size_t size);
+
+/**
+ * @brief Give the memory of committed pages back and make them inaccessible
+ * @param[in] addr The first page, page-aligned
+ * @param[in] size The size, a multiple of the page size
+ * @return 0 if successful, a negative value otherwise (-ENOTSUP without
+ *         system support)
+ */
+int mm_page_decommit(void *addr, size_t size);
+
+/**
+ * @brief Give the memory of page-aligned pages back to the system
+ *
+ * The pages stay mapped and read as zero on their next access. Works on any
+ * private anonymous memory, including page-aligned parts of heap buffers.
+ *
+ * @param[in] addr The first page, page-aligned
+ * @param[in] size The size, a multiple of the page size
+ *
+ * @return 0 if successful, a negative value otherwise (-ENOTSUP without
+ *         system support)
+ */
+int mm_page_release(void *addr, size_t size);
+
+/**
+ * @brief Count the bytes of a region that are resident in memory
+ *
+ * @param[in] addr The first page, page-aligned
+ * @param[in] size The size, a multiple of the page size
+ *
+ * @return the number of resident bytes, a negative value otherwise (-ENOTSUP
+ *         without system support)
+ */
+ssize_t mm_page_resident(void *addr, size_t size);
+
+/**
+ * @brief Fault in every page of a region ahead of its use
+ *
+ * Each page is read and written back, its content is kept.
+ *
+ * @param[in] addr The region
+ * @param[in] size The size of the region
+ * @param[out] faults The number of page faults taken (may be NULL)
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+int mm_page_prefault(void *addr, size_t size, size_t *faults);
+
+/**
+ * @brief Lock the pages of a region in memory
+ *
+ * @param[in] addr The region
+ * @param[in] size The size of the region
+ *
+ * @return 0 if successful, a negative value otherwise (-ENOTSUP without
+ *         system support)
+ */
+int mm_page_lock(void *addr, size_t size);
+
+/**
+ * @brief Unlock the pages of a region locked by mm_page_lock()
+ *
+ * @param[in] addr The region
+ * @param[in] size The size of the region
+ *
+ * @return 0 if successful, a negative value otherwise (-ENOTSUP without
+ *         system support)
+ */
+int mm_page_unlock(void *addr, size_t size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
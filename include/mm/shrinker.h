@@ -0,0 +1,190 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#pragma once
+
+/**
+ * @ingroup mm_components
+ */
+
+/**
+ * Shrinkers let caches (slab pools, arenas, application caches) give memory
+ * back when the process is under memory pressure, like Linux shrinkers do.
+ * A cache registers a shrinker telling how much memory it could give back
+ * (@a count) and how to give it back (@a scan).
+ *
+ * Shrinkers are run by mm_shrink(), or by mm_shrinker_poll() when:
+ * - the heap usage tracked by mm_malloc() (see mm_mt_activate()) went above
+ *   the threshold set by mm_shrinker_set_heap(),
+ * - the memory usage of the cgroup grows above the share of its limit set by
+ *   mm_shrinker_set_cgroup().
+ *
+ * Allocations never run the shrinkers themselves: mm_malloc() only records the
+ * heap usage, and the shrinkers run in the thread calling mm_shrinker_poll().
+ *
+ * Each shrinker is asked for a part of the memory to give back proportional to
+ * what it can give back, so that the usage drops to 7/8 of the threshold. The
+ * shrinkers are then not run again until memory freed by the application (not
+ * by the shrinkers) brings the usage below 7/8 of the threshold.
+ *
+ * @code
+ *
+ * static size_t slab_count(void *ctx)
+ * {
+ *     size_t esize, ecount, allocated, freed;
+ *
+ *     mm_slab_stats(ctx, &esize, &ecount, &allocated, NULL, &freed);
+ *     return (ecount - (allocated - freed)) * esize;
+ * }
+ *
+ * static size_t slab_scan(void *ctx, size_t target)
+ * {
+ *     ssize_t bytes = mm_slab_reclaim(ctx, target);
+ *
+ *     return bytes > 0 ? bytes : 0;
+ * }
+ *
+ * struct mm_shrinker shrinker = { slab_count, slab_scan, slab };
+ *
+ * mm_shrinker_register(&shrinker);
+ *
+ * // The pages given back lower the resident memory, not the tracked heap
+ * mm_shrinker_set_cgroup(NULL, 90); // shrink above 90% of memory.max
+ *
+ * for (;;) { // reclaim thread
+ *     mm_shrinker_poll();
+ *     sleep(1);
+ * }
+ *
+ * @endcode
+ *
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <sys/types.h>
+
+/* --------------------------------------------------------------------------
+ * PUBLIC TYPES
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief A shrinker, owned by the cache that registers it
+ */
+struct mm_shrinker {
+	/**
+	 * @brief Estimate the memory the cache can give back
+	 *
+	 * @param[in] ctx The shrinker context
+	 *
+	 * @return the number of bytes
+	 */
+	size_t (*count)(void *ctx);
+
+	/**
+	 * @brief Give memory back
+	 *
+	 * Called with the registry locked: it must not (un)register shrinkers.
+	 *
+	 * @param[in] ctx The shrinker context
+	 * @param[in] target The number of bytes to give back
+	 *
+	 * @return the number of bytes given back
+	 */
+	size_t (*scan)(void *ctx, size_t target);
+
+	void *ctx; /*!< Shrinker context */
+	struct mm_shrinker *next; /*!< Registry link, internal */
+};
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Register a shrinker
+ *
+ * @param[in] shrinker The shrinker, it must stay valid until unregistered
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+int mm_shrinker_register(struct mm_shrinker *shrinker);
+
+/**
+ * @brief Unregister a shrinker
+ *
+ * @param[in] shrinker The shrinker
+ *
+ * @return 0 if successful, -ENOENT if @a shrinker is not registered
+ */
+int mm_shrinker_unregister(struct mm_shrinker *shrinker);
+
+/**
+ * @brief Ask the registered shrinkers to give memory back
+ *
+ * Shrinkers are not run again while they are running (for instance when a
+ * shrinker allocates memory), mm_shrink() then returns 0.
+ *
+ * @param[in] target The number of bytes to give back, 0 for as much as possible
+ *
+ * @return the number of bytes given back
+ */
+size_t mm_shrink(size_t target);
+
+/**
+ * @brief Set the heap usage above which the shrinkers are run
+ *
+ * The usage is the one tracked by mm_malloc() and friends, memory tracking has
+ * to be enabled with mm_mt_activate(). The shrinkers are run by the next
+ * mm_shrinker_poll() once the usage went above @a threshold: they should give
+ * back heap memory, like caches of mm_malloc() blocks.
+ *
+ * @param[in] threshold The threshold in bytes, 0 to disable
+ */
+void mm_shrinker_set_heap(size_t threshold);
+
+/**
+ * @brief Report the heap usage to the shrinkers
+ *
+ * Called by mm_malloc() and friends each time the tracked usage changes, other
+ * allocators can report their usage as well. The usage is only recorded, see
+ * mm_shrinker_poll().
+ *
+ * @param[in] usage The heap usage in bytes
+ */
+void mm_shrinker_heap(size_t usage);
+
+/**
+ * @brief Set the cgroup memory usage above which the shrinkers are run
+ *
+ * @param[in] path The directory of the cgroup (v2), #MM_CGROUP_PATH if NULL
+ * @param[in] percent The share of memory.max above which the shrinkers are
+ *            run, 0 to disable
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+int mm_shrinker_set_cgroup(const char *path, unsigned int percent);
+
+/**
+ * @brief Check the heap usage and the memory usage of the cgroup, and run the
+ *        shrinkers if one is above its threshold
+ *
+ * Meant to be called periodically, for instance by the thread that reclaims the
+ * slab pools.
+ *
+ * @return the number of bytes given back, a negative value otherwise
+ *         (-ENOENT if the cgroup has no memory controller or no limit)
+ */
+ssize_t mm_shrinker_poll(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -16,6 +16,11 @@ extern "C" {
  * -------------------------------------------------------------------------- */
 
 #include <stdlib.h>
+#include <sys/types.h>
+
+#include <mm/config/config.h>
+#include <mm/numa.h>
+#include <mm/page.h>
 
 /* --------------------------------------------------------------------------
  * PUBLIC TYPES
@@ -26,6 +31,169 @@ extern "C" {
  */
 struct mm_slab;
 
+/**
+ * @brief Caller-provided memory for a slab descriptor, see mm_slab_init()
+ */
+struct mm_slab_storage {
+	unsigned char opaque[MM_SLAB_STORAGE_SIZE];
+} __attribute__((aligned(MM_CACHELINE_SIZE)));
+
+/**
+ * @def MM_SLAB_BITMAP_SIZE(ecount)
+ * @brief Size in bytes of the allocation bitmap of a pool of @a ecount elements
+ */
+#define MM_SLAB_BITMAP_SIZE(ecount) \
+	((((ecount) + 8 * sizeof(unsigned long) - 1) / (8 * sizeof(unsigned long))) * sizeof(unsigned long))
+
+/**
+ * @def MM_SLAB_BUFFER_SIZE(alignment, esize, ecount)
+ * @brief Size in bytes of a buffer holding a slab descriptor, its bitmap and
+ *        @a ecount elements of @a esize bytes aligned on @a alignment, to be
+ *        given to mm_slab_init() without storage
+ */
+#define MM_SLAB_BUFFER_SIZE(alignment, esize, ecount) \
+	(sizeof(struct mm_slab_storage) + MM_SLAB_BITMAP_SIZE(ecount) + \
+	 sizeof(unsigned long) + (alignment) + (esize) * (ecount))
+
+/**
+ * @def MM_SLAB_F_COLOUR
+ * @brief Colour the pool: its first element starts at a cache-line offset
+ *        that differs from one pool to the next. When the element size is a
+ *        multiple of #MM_COLOUR_SPAN, elements are also spaced by one extra
+ *        cache line so that they do not all land in the same cache set. When
+ *        the pool memory is allocated by the pool, the colour costs up to
+ *        #MM_COLOUR_SPAN extra bytes, plus the extra line per element. A pool
+ *        in a caller buffer only uses the space left past its elements, and is
+ *        not coloured if there is none.
+ */
+#define MM_SLAB_F_COLOUR (1u << 0)
+
+/**
+ * @def MM_SLAB_F_PAGES
+ * @brief Map the pool directly from the page provider instead of the heap
+ */
+#define MM_SLAB_F_PAGES (1u << 1)
+
+/**
+ * @def MM_SLAB_F_HUGEPAGE
+ * @brief Map the pool from the page provider, backed by huge pages when
+ *        possible (implies #MM_SLAB_F_PAGES)
+ */
+#define MM_SLAB_F_HUGEPAGE (1u << 2)
+
+/**
+ * @def MM_SLAB_F_PREFAULT
+ * @brief Fault in every page of the pool when it is created, so that the first
+ *        allocations do not page-fault
+ */
+#define MM_SLAB_F_PREFAULT (1u << 3)
+
+/**
+ * @def MM_SLAB_F_MLOCK
+ * @brief Lock the pool in memory, so that it is never paged out (implies
+ *        #MM_SLAB_F_PREFAULT). Creation fails if the pool cannot be locked,
+ *        see RLIMIT_MEMLOCK.
+ */
+#define MM_SLAB_F_MLOCK (1u << 4)
+
+/**
+ * @brief Object constructor, called once per element when the pool is created
+ *
+ * @param[in] obj The element to construct
+ * @param[in] ctx The user context given in struct mm_slab_config
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+typedef int (*mm_slab_ctor_t)(void *obj, void *ctx);
+
+/**
+ * @brief Object destructor, called once per element when the pool is destroyed
+ *
+ * @param[in] obj The element to destruct
+ * @param[in] ctx The user context given in struct mm_slab_config
+ */
+typedef void (*mm_slab_dtor_t)(void *obj, void *ctx);
+
+/**
+ * @brief Callback visiting an allocated element
+ *
+ * @param[in] obj The allocated element
+ * @param[in] ctx The user context given to the iteration
+ *
+ * @return 0 to continue the iteration, any other value stops it
+ */
+typedef int (*mm_slab_foreach_t)(void *obj, void *ctx);
+
+/**
+ * @brief Callback relocating an allocated element during compaction
+ *
+ * The owner copies the element from @a src to @a dst and updates every
+ * reference to it. @a dst is already reserved and @a src is released by the
+ * pool if the relocation succeeds. With a constructor, @a src must be left in
+ * a constructed state. The owner must make sure the element is not used nor
+ * freed concurrently.
+ *
+ * @param[in] dst The new location, free and reserved
+ * @param[in] src The element to move
+ * @param[in] ctx The user context given in struct mm_slab_config
+ *
+ * @return 0 if the element was moved, any other value if it cannot move
+ */
+typedef int (*mm_slab_relocate_t)(void *dst, void *src, void *ctx);
+
+/**
+ * @brief Configuration of a slab pool
+ *
+ * When a constructor is given, every element is constructed once when the pool
+ * is created and is expected to be put back into the pool in its constructed
+ * state: mm_slab_alloc() returns constructed objects without calling @a ctor
+ * again. The destructor is called on every element when the pool is destroyed.
+ *
+ * When @a path is set, the pool (header, allocation bitmap and elements) lives
+ * in a file mapped with MAP_SHARED, for instance on tmpfs, and @a buffer is
+ * ignored. If the file already holds a pool with the same geometry, the pool is
+ * reattached with its allocated elements, which are not constructed again; use
+ * mm_slab_foreach() to find them. mm_slab_destroy() then only detaches the pool
+ * (elements are neither checked nor destructed), and the file is kept. Only one
+ * process at a time can use the file. Elements should refer to each other by
+ * index (see mm_slab_index()) since the mapping address changes between runs.
+ */
+struct mm_slab_config {
+	void *buffer; /*!< Buffer to allocate from, allocated if NULL */
+	size_t size; /*!< Size of @a buffer in bytes, 0 if unknown */
+	size_t alignment; /*!< Element alignment (power of two), 0 if none */
+	size_t esize; /*!< Element size */
+	size_t ecount; /*!< Element count */
+	mm_slab_ctor_t ctor; /*!< Element constructor, may be NULL */
+	mm_slab_dtor_t dtor; /*!< Element destructor, may be NULL */
+	mm_slab_relocate_t relocate; /*!< Element relocation, enables
+					  mm_slab_compact(), may be NULL */
+	void *ctx; /*!< User context given to @a ctor, @a dtor and @a relocate */
+	unsigned int flags; /*!< MM_SLAB_F_* flags */
+	const struct mm_page_provider *provider; /*!< Page provider of the pool,
+						     the default one if NULL and
+						     MM_SLAB_F_PAGES is set */
+	struct mm_numa numa; /*!< NUMA placement of the pool, a policy other
+				  than MM_NUMA_DEFAULT implies MM_SLAB_F_PAGES
+				  (ignored for user buffers) */
+	const char *path; /*!< File backing the pool, see below, NULL if none */
+};
+
+/**
+ * @brief Counters of a slab pool, see mm_slab_counters()
+ *
+ * The average bitmap search length of an allocation, in bitmap words, is
+ * @a searched / (@a allocated + @a missed).
+ */
+struct mm_slab_counters {
+	size_t allocated; /*!< Number of allocations */
+	size_t missed; /*!< Number of allocations that found no room */
+	size_t freed; /*!< Number of frees */
+	size_t inuse; /*!< Number of elements currently allocated */
+	size_t hwm; /*!< Highest number of elements allocated at once */
+	size_t searched; /*!< Bitmap words scanned by allocations */
+};
+
 /* --------------------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------------------- */
@@ -45,6 +213,35 @@ struct mm_slab;
  */
 struct mm_slab *mm_slab_create(void *buffer, size_t alignment, size_t esize, size_t ecount);
 
+/**
+ * @brief Create a memory pool described by @a config
+ *
+ * @param[in] config The configuration of the pool
+ *
+ * @return an opaque descriptor for the slab pool, NULL otherwise (including when
+ *         @a config->ctor fails on one of the elements)
+ */
+struct mm_slab *mm_slab_create_config(const struct mm_slab_config *config);
+
+/**
+ * @brief Initialise a memory pool without any heap allocation
+ *
+ * The descriptor is stored in @a storage, or at the start of @a config->buffer
+ * if @a storage is NULL. The allocation bitmap is always placed in
+ * @a config->buffer, right before the elements, so that metadata and elements
+ * stay close. @a config->size must be large enough, see MM_SLAB_BUFFER_SIZE().
+ *
+ * The pool is released with mm_slab_destroy(), which does not free @a storage
+ * nor @a config->buffer.
+ *
+ * @param[in] storage The memory for the descriptor, may be NULL
+ * @param[in] config The configuration of the pool, @a buffer and @a size are
+ *            mandatory, @a path is not supported
+ *
+ * @return the slab descriptor, NULL otherwise
+ */
+struct mm_slab *mm_slab_init(struct mm_slab_storage *storage, const struct mm_slab_config *config);
+
 /**
  * @brief Destroy a slab pool
  *
@@ -73,9 +270,166 @@ void *mm_slab_alloc(struct mm_slab *slab);
  */
 int mm_slab_free(struct mm_slab *slab, void *ptr);
 
+/**
+ * @brief Get up to @a n free slabs from the slab pool at once
+ *
+ * The pool lock is taken once and the allocation bitmap is scanned a word at a
+ * time, which makes it much cheaper than @a n calls to mm_slab_alloc().
+ *
+ * @param[in] slab The buffer pool to allocate from
+ * @param[out] ptrs The array receiving the allocated buffers
+ * @param[in] n The number of buffers requested
+ *
+ * @return the number of buffers stored in @a ptrs (less than @a n if the pool
+ *         is exhausted), a negative value otherwise
+ */
+int mm_slab_alloc_bulk(struct mm_slab *slab, void **ptrs, size_t n);
+
+/**
+ * @brief Put back @a n pointers to the slab pool at once
+ *
+ * Every pointer is checked before any of them is released: if one of them does
+ * not belong to @a slab, nothing is released.
+ *
+ * @param[in] slab The buffer pool to use
+ * @param[in] ptrs The pointers to put back into @a slab
+ * @param[in] n The number of pointers in @a ptrs
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+int mm_slab_free_bulk(struct mm_slab *slab, void **ptrs, size_t n);
+
+/**
+ * @brief Visit every allocated element of a slab pool
+ *
+ * The allocation bitmap is read a word at a time under the pool lock, and the
+ * callback is called without holding it: @a cb may free the visited element
+ * (or any other one). Elements allocated during the iteration may or may not
+ * be visited.
+ *
+ * @param[in] slab The buffer pool to use
+ * @param[in] cb The callback called on each allocated element
+ * @param[in] ctx The user context given to @a cb
+ *
+ * @return 0 if every element was visited, the non-zero value returned by @a cb
+ *         if it stopped the iteration, a negative value on error
+ */
+int mm_slab_foreach(struct mm_slab *slab, mm_slab_foreach_t cb, void *ctx);
+
+/**
+ * @brief Compact a slab pool
+ *
+ * Live elements are moved, through the relocation callback, from the end of
+ * the pool to the free slots at its start, so that they are densely packed.
+ * The memory of every page left without any live element is then given back
+ * to the system, when the pool owns it (not for user buffers) and has no
+ * constructor.
+ *
+ * @param[in] slab The buffer pool to compact
+ * @param[out] moved The number of relocated elements, may be NULL
+ * @param[out] released The number of bytes given back, may be NULL
+ *
+ * @return 0 if successful, -ENOTSUP if the pool has no relocation callback, a
+ *         negative value otherwise
+ */
+int mm_slab_compact(struct mm_slab *slab, size_t *moved, size_t *released);
+
+/**
+ * @brief Give the memory of free elements back to the system
+ *
+ * Every run of whole pages that holds no allocated element is released
+ * (madvise(MADV_DONTNEED)); the pages stay mapped and are faulted in again when
+ * their elements are allocated. Pools with a constructor, locked pools, user
+ * buffers and file-backed pools keep their memory.
+ *
+ * @param[in] slab The buffer pool to use
+ * @param[in] limit Stop once this many bytes are given back, 0 for no limit
+ *
+ * @return the number of resident bytes given back, a negative value otherwise
+ */
+ssize_t mm_slab_reclaim(struct mm_slab *slab, size_t limit);
+
+/**
+ * @brief Get the index of an element in its pool
+ *
+ * @param[in] slab The buffer pool to use
+ * @param[in] ptr The element
+ *
+ * @return the index of @a ptr, a negative value if it is not an element of
+ *         @a slab
+ */
+ssize_t mm_slab_index(struct mm_slab *slab, const void *ptr);
+
+/**
+ * @brief Tell whether an element of a pool is allocated
+ *
+ * The allocation bitmap is read without taking the pool lock: the answer is
+ * only reliable for an element the caller owns, for instance to reject a
+ * double free.
+ *
+ * @param[in] slab The buffer pool to use
+ * @param[in] ptr The element
+ *
+ * @return 1 if @a ptr is allocated, 0 if it is free, a negative value if it is
+ *         not an element of @a slab
+ */
+int mm_slab_inuse(struct mm_slab *slab, const void *ptr);
+
+/**
+ * @brief Get the address range of the elements of a pool
+ *
+ * Every element of @a slab lies in [@a start, @a end), the range never changes
+ * during the life of the pool.
+ *
+ * @param[in] slab The buffer pool to use
+ * @param[out] start The address of the first element
+ * @param[out] end The address past the last element
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+int mm_slab_range(struct mm_slab *slab, void **start, void **end);
+
+/**
+ * @brief Get an element from its index in the pool
+ *
+ * @param[in] slab The buffer pool to use
+ * @param[in] idx The index of the element
+ *
+ * @return the element (allocated or not), NULL if @a idx is out of the pool
+ */
+void *mm_slab_ptr(struct mm_slab *slab, size_t idx);
+
+/**
+ * @brief Get the memory residency stats of a pool
+ *
+ * @param[in] slab The buffer pool to use
+ * @param[out] prefaulted The number of bytes faulted in at creation
+ * @param[out] faults The number of page faults taken at creation, that the
+ *             first allocations avoid
+ * @param[out] locked The number of bytes locked in memory
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+int mm_slab_mem_stats(struct mm_slab *slab, size_t *prefaulted, size_t *faults, size_t *locked);
+
+/**
+ * @brief Get the counters of a memory pool
+ *
+ * The counters are read without taking the pool lock: each of them is exact,
+ * but they may be taken at slightly different times while the pool is in use.
+ *
+ * @param[in] slab The buffer pool to use
+ * @param[out] counters The counters
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+int mm_slab_counters(struct mm_slab *slab, struct mm_slab_counters *counters);
+
 /**
  * @brief Get stats from a memory pool
  *
+ * The stats are read without taking the pool lock, see mm_slab_counters().
+ *
  * @param[in] slab The buffer pool to use
  * @param[out] esize The maximum size of one element in the pool
  * @param[out] ecount The number of element in the pool
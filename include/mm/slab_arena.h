@@ -26,6 +26,20 @@
  * occupation of the pools. With those values, you might tune up/down the various
  * pools and let almost large allocation to the default memory allocation.
  *
+ * The arena can also do it by itself: each call to mm_slab_arena_adapt() adds
+ * pools to the classes that missed allocations and gives back the extra pools
+ * of the classes that did not, within a memory budget. The configuration it
+ * converged on is retrieved with mm_slab_arena_get_config() and can be used as
+ * the static configuration of the next runs.
+ *
+ * Allocations, frees and the stats of an arena can run from several threads at
+ * once. mm_slab_arena_adapt(), and mm_slab_arena_destroy() when it leaves busy
+ * pools, destroy pools and replace the table that finds the pool of a buffer:
+ * they must run while no other thread uses the arena, for any function.
+ *
+ * Offline, mm_slab_arena_plan() or the slab_arena_config tool compute the
+ * classes from a size histogram or an allocation trace.
+ *
  * It is mandatory to initialise a slaba rena as in the following example:
  *
  * @code
@@ -41,6 +55,30 @@
  *     { 4096, 32 } // 32 buffers for allocation smaller than 4096
  * };
  *
+ * // Large pools can be mapped directly on huge pages
+ * struct mm_slab_arena_config _sarena_large[1] = {
+ *     { 4096, 65536, MM_SLAB_F_HUGEPAGE },
+ * };
+ *
+ * // ... and placed on a given NUMA node
+ * struct mm_slab_arena_config _sarena_node1[1] = {
+ *     { 4096, 65536, MM_SLAB_F_HUGEPAGE, { MM_NUMA_NODE, 1 } },
+ * };
+ *
+ * // Latency-critical pools are faulted in and locked at creation
+ * struct mm_slab_arena_config _sarena_locked[1] = {
+ *     { 256, 4096, MM_SLAB_F_PREFAULT | MM_SLAB_F_MLOCK },
+ * };
+ *
+ * // All the pools in one reservation of 64 MiB per class
+ * mm_slab_arena_create_reserved(_sarena_config, 6, 64 << 20);
+ *
+ * // Independent arenas have their own configuration, e.g. one per NUMA node
+ * struct mm_slab_arena *node1;
+ * mm_slab_arena_create_r(&node1, _sarena_node1, 1);
+ * ptr = mm_slab_arena_malloc_r(node1, 4000);
+ * mm_slab_arena_free_r(node1, ptr);
+ *
  * int main(void)
  * {
  *     int err;
@@ -71,22 +109,41 @@ extern "C" {
  * HEADERS
  * -------------------------------------------------------------------------- */
 
+#include <stdint.h>
 #include <stdlib.h>
 
+#include <mm/numa.h>
+#include <mm/slab.h>
+
 /* --------------------------------------------------------------------------
  * PUBLIC TYPES
  * -------------------------------------------------------------------------- */
 
+/**
+ * @brief Opaque type of a slab arena, see mm_slab_arena_create_r()
+ */
+struct mm_slab_arena;
+
 /**
  * @brief Configuration of kmem pools
  */
 struct mm_slab_arena_config {
 	size_t esize; /*<! Element size */
 	size_t ecount; /*<! Element count */
+	unsigned int flags; /*<! MM_SLAB_F_* flags of the pool (optional) */
+	struct mm_numa numa; /*<! NUMA placement of the pool (optional) */
+};
+
+/**
+ * @brief Number of objects of a given size, see mm_slab_arena_plan()
+ */
+struct mm_slab_arena_size {
+	size_t size; /*<! Requested size */
+	size_t count; /*<! Number of objects to hold at once */
 };
 
 /**
- * @brief Kmem Pool Statistics
+ * @brief Kmem Pool Statistics, the counters add up the pools of a size class
  */
 struct mm_slab_arena_stats {
 	size_t esize; /*<! Element size */
@@ -95,6 +152,14 @@ struct mm_slab_arena_stats {
 	size_t missed; /*<! Total number of missed allocation (allocation that
 			    should have happen in this pool but no room left) */
 	size_t freed; /*<! Total number of memory release */
+	size_t inuse; /*<! Number of buffers currently allocated */
+	size_t hwm; /*<! Highest number of buffers allocated at once */
+	size_t spilled; /*<! Number of allocations that should have happen in this
+			     pool but were served by a larger one, see
+			     mm_slab_arena_spill() */
+	size_t faults; /*<! Page faults taken at creation by a pool created
+			    with MM_SLAB_F_PREFAULT, avoided later */
+	size_t locked; /*<! Bytes locked in memory (MM_SLAB_F_MLOCK) */
 };
 
 /* --------------------------------------------------------------------------
@@ -104,38 +169,114 @@ struct mm_slab_arena_stats {
 /**
  * @brief Create a set of memory pools to allocate buffers
  *
+ * The functions without handle use the default arena created by this function.
+ * Independent arenas, for instance one per subsystem, per worker thread or per
+ * NUMA node, are created with mm_slab_arena_create_r() and used with the
+ * functions of the same name suffixed by _r.
+ *
  * @param[in] config The configuration of underlying pools (sorted by esize)
  * @param[in] ecount The number of pools in the kmem
  *
- * @return 0 if successful, < 0 otherwise
+ * @return 0 if successful, < 0 otherwise (-EBUSY if the default arena exists)
  */
 int mm_slab_arena_create(struct mm_slab_arena_config *config, size_t count);
 
+/**
+ * @brief Create an independent arena, see mm_slab_arena_create()
+ *
+ * @param[out] arena The new arena
+ * @param[in] config The configuration of underlying pools (sorted by esize)
+ * @param[in] count The number of pools in the arena
+ *
+ * @return 0 if successful, < 0 otherwise
+ */
+int mm_slab_arena_create_r(struct mm_slab_arena **arena, struct mm_slab_arena_config *config, size_t count);
+
+/**
+ * @brief Create the default arena with all its pools in one reservation
+ *
+ * Instead of a memory region per pool, the arena reserves address space once,
+ * without memory. Each class gets a span of @a span bytes (rounded up to a
+ * power of two) at offset index * span, its pools are committed one after the
+ * other in it and decommitted when retired by mm_slab_arena_adapt(). The class
+ * of a pointer is then found by arithmetic, and the whole arena is a single
+ * mapping for the kernel, aligned for transparent huge pages when a class is
+ * created with MM_SLAB_F_HUGEPAGE.
+ *
+ * A class whose pools do not fit in its span behaves like a pool that could
+ * not be created. Requires mmap(), see mm_page_reserve().
+ *
+ * @param[in] config The configuration of underlying pools (sorted by esize)
+ * @param[in] count The number of pools in the arena
+ * @param[in] span The address space reserved for each class, in bytes
+ *
+ * @return 0 if successful, < 0 otherwise (-EBUSY if the default arena exists)
+ */
+int mm_slab_arena_create_reserved(struct mm_slab_arena_config *config, size_t count, size_t span);
+
+/**
+ * @brief Create an independent arena in one reservation, see
+ *        mm_slab_arena_create_reserved()
+ *
+ * @param[out] arena The new arena
+ * @param[in] config The configuration of underlying pools (sorted by esize)
+ * @param[in] count The number of pools in the arena
+ * @param[in] span The address space reserved for each class, in bytes
+ *
+ * @return 0 if successful, < 0 otherwise
+ */
+int mm_slab_arena_create_reserved_r(struct mm_slab_arena **arena, struct mm_slab_arena_config *config,
+				    size_t count, size_t span);
+
 /**
  * @brief Destroy kmem pools
  *
  * @note Kmem will destroy all empty pools, and return -EAGAIN if any of the pool is
- * not empty.
+ * not empty. No other thread may use the arena meanwhile, see
+ * mm_slab_arena_adapt().
  *
  * @return 0 if successful, < 0 otherwise
  */
 int mm_slab_arena_destroy(void);
 
+/**
+ * @brief Destroy an arena, see mm_slab_arena_destroy()
+ *
+ * @param[in] arena The arena, released if successful
+ *
+ * @return 0 if successful, < 0 otherwise
+ */
+int mm_slab_arena_destroy_r(struct mm_slab_arena *arena);
+
 /**
  * @brief The mm_slab_arena_malloc() function allocates size bytes and returns a pointer
  *        to the allocated memory. The memory is not initialized.
  *
+ * Not to be called while mm_slab_arena_adapt() runs.
+ *
  * @param[in] size The requested size to allocate
  *
  * @return a pointer to the allocated buffer, NULL if none left in the slab pool
  */
 void *mm_slab_arena_malloc(size_t size);
 
+/**
+ * @brief Allocate from an arena, see mm_slab_arena_malloc()
+ *
+ * @param[in] arena The arena
+ * @param[in] size The requested size to allocate
+ *
+ * @return a pointer to the allocated buffer, NULL otherwise
+ */
+void *mm_slab_arena_malloc_r(struct mm_slab_arena *arena, size_t size);
+
 /**
  * @brief The mm_slab_arena_calloc() function allocates memory for an array of nmemb
  *        elements of size bytes each and returns a pointer to the allocated memory.
  *        The memory is set to zero.
  *
+ * Not to be called while mm_slab_arena_adapt() runs.
+ *
  * @param[in] nmemb The number of element
  * @param[in] size The size of one element
  *
@@ -143,21 +284,204 @@ void *mm_slab_arena_malloc(size_t size);
  */
 void *mm_slab_arena_calloc(size_t nmemb, size_t size);
 
+/**
+ * @brief Allocate zeroed memory from an arena, see mm_slab_arena_calloc()
+ *
+ * @param[in] arena The arena
+ * @param[in] nmemb The number of element
+ * @param[in] size The size of one element
+ *
+ * @return a pointer to the allocated buffer, NULL otherwise
+ */
+void *mm_slab_arena_calloc_r(struct mm_slab_arena *arena, size_t nmemb, size_t size);
+
+/**
+ * @brief Change the size of memory allocated with mm_slab_arena_malloc()
+ *
+ * The old size is the element size of the pool owning @a ptr. When @a size
+ * still fits in it, the element moves down to the smallest class of @a size
+ * that has room, or stays in place if there is none. Otherwise the element is
+ * copied once to a buffer of the class of @a size, or of the heap fallback,
+ * then released. A buffer of the heap fallback is given to mm_realloc(). A pointer
+ * within a pool that is not one of its elements is rejected. Not to be called
+ * while mm_slab_arena_adapt() runs.
+ *
+ * @param[in] ptr The pointer to the allocated memory, NULL to allocate
+ * @param[in] size The new size, 0 to free @a ptr
+ *
+ * @return a pointer to the reallocated buffer, NULL otherwise (@a ptr is then
+ *         left untouched, unless @a size is 0)
+ */
+void *mm_slab_arena_realloc(void *ptr, size_t size);
+
+/**
+ * @brief Change the size of memory allocated from an arena, see
+ *        mm_slab_arena_realloc()
+ *
+ * @param[in] arena The arena @a ptr was allocated from
+ * @param[in] ptr The pointer to the allocated memory, NULL to allocate
+ * @param[in] size The new size, 0 to free @a ptr
+ *
+ * @return a pointer to the reallocated buffer, NULL otherwise
+ */
+void *mm_slab_arena_realloc_r(struct mm_slab_arena *arena, void *ptr, size_t size);
+
 /**
  * @brief The free() function frees the memory space pointed to by ptr, which must
  *        have been returned by a previous call to malloc() or related functions.
  *        Otherwise, or if ptr has already been freed, undefined behavior occurs.
  *        If ptr is NULL, no operation is performed.
  *
+ * Not to be called while mm_slab_arena_adapt() runs.
+ *
  * @param[in] ptr The pointer to the allocated memory
  *
  * @return 0 if successful, < 0 otherwise
  */
 int mm_slab_arena_free(void *ptr);
 
+/**
+ * @brief Free memory allocated from an arena, see mm_slab_arena_free()
+ *
+ * @param[in] arena The arena @a ptr was allocated from
+ * @param[in] ptr The pointer to the allocated memory
+ *
+ * @return 0 if successful, < 0 otherwise
+ */
+int mm_slab_arena_free_r(struct mm_slab_arena *arena, void *ptr);
+
+/**
+ * @brief Set how far an allocation spills over when its pool is exhausted
+ *
+ * By default, an allocation whose pool is exhausted falls back to the default
+ * memory allocation. With a spill of N, the N next larger pools are tried
+ * first, so that bursts stay in the slab pools. Spilled allocations are
+ * counted in the `spilled` stats of the exhausted pool.
+ *
+ * @param[in] classes The number of larger pools to try, 0 for none
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+int mm_slab_arena_spill(unsigned int classes);
+
+/**
+ * @brief Set the spill of an arena, see mm_slab_arena_spill()
+ *
+ * @param[in] arena The arena
+ * @param[in] classes The number of larger pools to try, 0 for none
+ *
+ * @return 0 if successful, a negative value otherwise
+ */
+int mm_slab_arena_spill_r(struct mm_slab_arena *arena, unsigned int classes);
+
+/**
+ * @brief Put a per-thread cache of free elements in front of the pools
+ *
+ * Each thread keeps up to @a count free elements per pool. Allocations and
+ * frees then pop and push these caches without taking the pool lock; a cache
+ * is refilled from, or flushed to, its pool by half at once with the bulk
+ * functions. The cache of a thread goes back to the pools when the thread
+ * exits, and every cache is flushed when the arena is destroyed.
+ *
+ * Cached elements are accounted as in use in the stats of their pool, see
+ * mm_slab_arena_tcache_flush(), but are not visited by
+ * mm_slab_arena_foreach(). A double free of a cached element is undefined; debug
+ * builds ignore it when the element is already free in its pool or cached by
+ * the calling thread.
+ *
+ * @param[in] count The number of cached elements per pool and per thread
+ *
+ * @return 0 if successful, -EBUSY if already enabled, < 0 otherwise
+ */
+int mm_slab_arena_tcache(unsigned int count);
+
+/**
+ * @brief Enable the thread caches of an arena, see mm_slab_arena_tcache()
+ *
+ * @param[in] arena The arena
+ * @param[in] count The number of cached elements per pool and per thread
+ *
+ * @return 0 if successful, -EBUSY if already enabled, < 0 otherwise
+ */
+int mm_slab_arena_tcache_r(struct mm_slab_arena *arena, unsigned int count);
+
+/**
+ * @brief Give the elements cached by the calling thread back to the pools
+ *
+ * @return 0 if successful, < 0 otherwise
+ */
+int mm_slab_arena_tcache_flush(void);
+
+/**
+ * @brief Flush the calling thread cache of an arena, see
+ *        mm_slab_arena_tcache_flush()
+ *
+ * @param[in] arena The arena
+ *
+ * @return 0 if successful, < 0 otherwise
+ */
+int mm_slab_arena_tcache_flush_r(struct mm_slab_arena *arena);
+
+/**
+ * @brief Visit every element allocated from the slab pools of the arena
+ *
+ * Pools are visited by increasing element size, see mm_slab_foreach(). Buffers
+ * that fell back to the default memory allocation and elements held by a thread
+ * cache are not visited: the cached elements of a class are copied once before
+ * its pools are visited, an element cached or taken by another thread during
+ * the iteration may or may not be visited. Not to be called while
+ * mm_slab_arena_adapt() runs.
+ *
+ * @param[in] cb The callback called on each allocated element
+ * @param[in] ctx The user context given to @a cb
+ *
+ * @return 0 if every element was visited, the non-zero value returned by @a cb
+ *         if it stopped the iteration, a negative value on error
+ */
+int mm_slab_arena_foreach(mm_slab_foreach_t cb, void *ctx);
+
+/**
+ * @brief Visit every element allocated from an arena, see
+ *        mm_slab_arena_foreach()
+ *
+ * @param[in] arena The arena
+ * @param[in] cb The callback called on each allocated element
+ * @param[in] ctx The user context given to @a cb
+ *
+ * @return 0 if every element was visited, the non-zero value returned by @a cb
+ *         if it stopped the iteration, a negative value on error
+ */
+int mm_slab_arena_foreach_r(struct mm_slab_arena *arena, mm_slab_foreach_t cb, void *ctx);
+
+/**
+ * @brief Give the memory of free elements of the arena back to the system
+ *
+ * Pools are reclaimed by increasing element size, see mm_slab_reclaim().
+ *
+ * @param[in] limit Stop once this many bytes are given back, 0 for no limit
+ *
+ * @return the number of resident bytes given back, a negative value otherwise
+ */
+ssize_t mm_slab_arena_reclaim(size_t limit);
+
+/**
+ * @brief Give the memory of free elements of an arena back to the system, see
+ *        mm_slab_arena_reclaim()
+ *
+ * @param[in] arena The arena
+ * @param[in] limit Stop once this many bytes are given back, 0 for no limit
+ *
+ * @return the number of resident bytes given back, a negative value otherwise
+ */
+ssize_t mm_slab_arena_reclaim_r(struct mm_slab_arena *arena, size_t limit);
+
 /**
  * @brief Retrieve stats on the kmem pool
  *
+ * The array is allocated with mm_calloc() on each call, see
+ * mm_slab_arena_snapshot() to poll the stats without allocating. Not to be
+ * called while mm_slab_arena_adapt() runs.
+ *
  * @param[out] stats A placeholder for the array to be retrieved
  * @param[out] count the number of pools inside the kmem pool
  *
@@ -165,6 +489,161 @@ int mm_slab_arena_free(void *ptr);
  */
 int mm_slab_arena_stats(struct mm_slab_arena_stats **stats, size_t *count);
 
+/**
+ * @brief Retrieve stats on an arena, see mm_slab_arena_stats()
+ *
+ * @param[in] arena The arena
+ * @param[out] stats A placeholder for the array to be retrieved
+ * @param[out] count the number of pools inside the arena
+ *
+ * @return the number of pools if successful, < 0 otherwise
+ */
+int mm_slab_arena_stats_r(struct mm_slab_arena *arena, struct mm_slab_arena_stats **stats, size_t *count);
+
+/**
+ * @brief Fill a caller buffer with the stats of the arena
+ *
+ * The stats are read from the relaxed atomic counters of the pools, without
+ * lock nor allocation, so they can be polled from a monitoring thread while
+ * other threads allocate and free. Each counter is exact, the snapshot as a
+ * whole is not taken at a single instant. A class without pool reports zeros.
+ *
+ * The pools are read in place: the poller must not run while
+ * mm_slab_arena_adapt() or mm_slab_arena_destroy() change them.
+ *
+ * @param[out] stats The buffer receiving one entry per class, may be NULL if
+ *                   @a count is 0
+ * @param[in] count The number of entries of @a stats, the first @a count
+ *                  classes are filled
+ * @param[out] generation The generation of the stats, see
+ *                        mm_slab_arena_generation() (may be NULL)
+ *
+ * @return the number of classes of the arena if successful, < 0 otherwise
+ */
+int mm_slab_arena_snapshot(struct mm_slab_arena_stats *stats, size_t count, uint64_t *generation);
+
+/**
+ * @brief Fill a caller buffer with the stats of an arena, see
+ *        mm_slab_arena_snapshot()
+ *
+ * @param[in] arena The arena
+ * @param[out] stats The buffer receiving one entry per class
+ * @param[in] count The number of entries of @a stats
+ * @param[out] generation The generation of the stats (may be NULL)
+ *
+ * @return the number of classes of the arena if successful, < 0 otherwise
+ */
+int mm_slab_arena_snapshot_r(struct mm_slab_arena *arena, struct mm_slab_arena_stats *stats, size_t count,
+			     uint64_t *generation);
+
+/**
+ * @brief Get the generation of the arena stats
+ *
+ * The generation is the sum of the monotonic counters of the arena (allocated,
+ * missed, freed, spilled and the pools added or retired): it changes whenever
+ * the stats do, so that a poller can skip a snapshot of an unchanged arena. It
+ * is read without lock nor allocation, under the same conditions as
+ * mm_slab_arena_snapshot().
+ *
+ * @return the generation, 0 without arena
+ */
+uint64_t mm_slab_arena_generation(void);
+
+/**
+ * @brief Get the generation of the stats of an arena, see
+ *        mm_slab_arena_generation()
+ *
+ * @param[in] arena The arena
+ *
+ * @return the generation, 0 without arena
+ */
+uint64_t mm_slab_arena_generation_r(struct mm_slab_arena *arena);
+
+/**
+ * @brief Resize the size classes of the arena from their recent use
+ *
+ * Since the previous call, a class that missed allocations doubles its number
+ * of elements with a new pool, the classes with the most misses first, as long
+ * as the pools of the arena fit in @a budget. A class that missed none gives
+ * its last added pool back once it is empty and the other pools of the class
+ * stay half free. A class keeps at least its configured pool and has at most
+ * MM_SLAB_ARENA_SLABS pools.
+ *
+ * The adaptive mode is opt-in: it runs on every call of this function, e.g.
+ * between the phases of the application. It destroys pools and replaces the
+ * table that finds the pool of a buffer, without lock: no other thread may use
+ * the arena meanwhile, allocations, frees, mm_slab_arena_snapshot() and
+ * mm_slab_arena_generation() included.
+ *
+ * @param[in] budget The largest size of the elements of all the pools, in bytes
+ *
+ * @return the number of pools added or given back, < 0 otherwise
+ */
+ssize_t mm_slab_arena_adapt(size_t budget);
+
+/**
+ * @brief Resize the size classes of an arena, see mm_slab_arena_adapt()
+ *
+ * @param[in] arena The arena
+ * @param[in] budget The largest size of the elements of all the pools, in bytes
+ *
+ * @return the number of pools added or given back, < 0 otherwise
+ */
+ssize_t mm_slab_arena_adapt_r(struct mm_slab_arena *arena, size_t budget);
+
+/**
+ * @brief Retrieve the current configuration of the arena
+ *
+ * The element count of each class is the total of its pools, e.g. after
+ * mm_slab_arena_adapt(), so that it can be given to mm_slab_arena_create().
+ *
+ * @param[out] config A placeholder for the array to be retrieved, to be
+ *                    released with mm_free()
+ * @param[out] count The number of classes of the arena
+ *
+ * @return the number of classes if successful, < 0 otherwise
+ */
+int mm_slab_arena_get_config(struct mm_slab_arena_config **config, size_t *count);
+
+/**
+ * @brief Retrieve the current configuration of an arena, see
+ *        mm_slab_arena_get_config()
+ *
+ * @param[in] arena The arena
+ * @param[out] config A placeholder for the array to be retrieved
+ * @param[out] count The number of classes of the arena
+ *
+ * @return the number of classes if successful, < 0 otherwise
+ */
+int mm_slab_arena_get_config_r(struct mm_slab_arena *arena, struct mm_slab_arena_config **config, size_t *count);
+
+/**
+ * @brief Compute the configuration of an arena from a size histogram
+ *
+ * The classes are chosen to hold the objects of @a hist with the least memory
+ * lost to rounding up to the element sizes, in at most @a classes classes.
+ * When they do not fit in @a budget, the largest objects are left to the heap
+ * fallback, as long as they are at most @a miss of all the objects.
+ *
+ * Beyond 256 distinct element sizes, neighbouring sizes are merged two by two
+ * before the classes are chosen, which bounds the cost of the search at the
+ * price of some more rounding.
+ *
+ * @param[in] hist The number of objects per size, in any order
+ * @param[in] n The number of entries of @a hist
+ * @param[in] budget The largest size of the elements of all the pools, in bytes
+ * @param[in] miss The largest share of the objects left to the heap (0 to 1)
+ * @param[in] classes The largest number of classes
+ * @param[out] config A placeholder for the configuration, sorted by element
+ *                    size, to be released with mm_free()
+ * @param[out] count The number of classes of @a config
+ *
+ * @return the number of classes if successful, -ENOSPC if @a budget cannot be
+ *         met within @a miss, < 0 otherwise
+ */
+int mm_slab_arena_plan(const struct mm_slab_arena_size *hist, size_t n, size_t budget, double miss,
+		       size_t classes, struct mm_slab_arena_config **config, size_t *count);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,95 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#pragma once
+
+/**
+ * @ingroup mm_components
+ */
+
+/**
+ * A slab reclaimer is a background thread that periodically gives the memory of
+ * free elements of a set of slab pools back to the system, see
+ * mm_slab_reclaim(). The amount of memory given back per period is rate
+ * limited, so that a pool shrinking after a peak does not stall its users, and
+ * so that memory about to be reused is not released all at once.
+ *
+ * @code
+ *
+ * struct mm_slab *slabs[2] = { small, large };
+ * struct mm_slab_reclaimer *reclaimer;
+ *
+ * // Every second, give back at most 1 MiB
+ * reclaimer = mm_slab_reclaimer_start(slabs, 2, 1000, 1 << 20);
+ * // ... skipped
+ * mm_slab_reclaimer_stop(reclaimer); // before destroying the pools
+ *
+ * @endcode
+ *
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <sys/types.h>
+
+#include <mm/slab.h>
+
+/* --------------------------------------------------------------------------
+ * PUBLIC TYPES
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Opaque structure for a background reclaimer
+ */
+struct mm_slab_reclaimer;
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Start reclaiming the memory of slab pools in the background
+ *
+ * The pools must not be destroyed before the reclaimer is stopped.
+ *
+ * @param[in] slabs The pools to reclaim (the array is copied)
+ * @param[in] count The number of pools
+ * @param[in] period_ms The time between two reclaims, in milliseconds
+ * @param[in] rate The maximum number of bytes given back per period, 0 for no
+ *            limit
+ *
+ * @return the reclaimer, NULL otherwise
+ */
+struct mm_slab_reclaimer *mm_slab_reclaimer_start(struct mm_slab **slabs, size_t count,
+						  unsigned int period_ms, size_t rate);
+
+/**
+ * @brief Get the number of bytes given back so far by a reclaimer
+ *
+ * @param[in] reclaimer The reclaimer
+ *
+ * @return the number of bytes, a negative value otherwise
+ */
+ssize_t mm_slab_reclaimer_bytes(struct mm_slab_reclaimer *reclaimer);
+
+/**
+ * @brief Stop a reclaimer and release it
+ *
+ * @param[in] reclaimer The reclaimer
+ *
+ * @return the number of bytes given back by the reclaimer, a negative value
+ *         otherwise
+ */
+ssize_t mm_slab_reclaimer_stop(struct mm_slab_reclaimer *reclaimer);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
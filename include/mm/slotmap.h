@@ -0,0 +1,158 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#pragma once
+
+/**
+ * @ingroup mm_components
+ */
+
+/**
+ * A slot map stores objects in a slab pool and hands out handles instead of
+ * pointers. A handle packs the index of the object in the pool and a
+ * generation of its slot; the generation changes each time the slot is
+ * allocated or freed, so that a handle to a freed object is detected by
+ * mm_slotmap_get() rather than giving access to whatever lives there now.
+ *
+ * Handles are 64-bit, or fit in 32 bits when the slot map is created with
+ * @a handle_bits set to 32: the index takes the bits needed by the element
+ * count, the generation the remaining ones. With fewer generation bits, a
+ * stale handle is reused (not detected) after the slot has been allocated
+ * 2^(bits - 1) more times.
+ *
+ * A handle of 0 is never valid. Objects stay at the same address while they
+ * are allocated; a slot map does not synchronise lookups with frees, the
+ * application has to.
+ *
+ * @code
+ *
+ * struct mm_slotmap_config config = {
+ *     .slab = { .esize = sizeof(struct node), .ecount = 1 << 20 },
+ *     .handle_bits = 32,
+ * };
+ * struct mm_slotmap *map = mm_slotmap_create(&config);
+ * mm_slotmap_handle_t h;
+ * struct node *n = mm_slotmap_alloc(map, &h);
+ *
+ * // ... skipped
+ * mm_slotmap_free(map, h);
+ * n = mm_slotmap_get(map, h); // NULL
+ *
+ * @endcode
+ *
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <mm/slab.h>
+
+/* --------------------------------------------------------------------------
+ * PUBLIC TYPES
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Opaque type of a slot map
+ */
+struct mm_slotmap;
+
+/**
+ * @brief A handle to an object of a slot map, fits in an uint32_t when the
+ *        slot map has 32-bit handles
+ */
+typedef uint64_t mm_slotmap_handle_t;
+
+/**
+ * @brief Configuration of a slot map
+ */
+struct mm_slotmap_config {
+	struct mm_slab_config slab; /*!< Configuration of the underlying pool */
+	unsigned int handle_bits; /*!< 32 or 64 (default if 0) */
+};
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create a slot map
+ *
+ * @param[in] config The configuration of the slot map, the pool must leave at
+ *            least 2 generation bits in a handle and cannot be file-backed
+ *
+ * @return the slot map, NULL otherwise
+ */
+struct mm_slotmap *mm_slotmap_create(const struct mm_slotmap_config *config);
+
+/**
+ * @brief Destroy a slot map
+ *
+ * @param[in] map The slot map
+ *
+ * @return 0 if successful, a negative value otherwise (-EAGAIN if objects are
+ *         still allocated)
+ */
+int mm_slotmap_destroy(struct mm_slotmap *map);
+
+/**
+ * @brief Allocate an object
+ *
+ * @param[in] map The slot map
+ * @param[out] handle The handle of the object
+ *
+ * @return the object, NULL otherwise
+ */
+void *mm_slotmap_alloc(struct mm_slotmap *map, mm_slotmap_handle_t *handle);
+
+/**
+ * @brief Free an object
+ *
+ * @param[in] map The slot map
+ * @param[in] handle The handle of the object
+ *
+ * @return 0 if successful, -ESTALE if the object was already freed, another
+ *         negative value otherwise
+ */
+int mm_slotmap_free(struct mm_slotmap *map, mm_slotmap_handle_t handle);
+
+/**
+ * @brief Get an object from its handle
+ *
+ * @param[in] map The slot map
+ * @param[in] handle The handle of the object
+ *
+ * @return the object, NULL if @a handle is invalid or the object was freed
+ */
+void *mm_slotmap_get(struct mm_slotmap *map, mm_slotmap_handle_t handle);
+
+/**
+ * @brief Get the handle of an allocated object
+ *
+ * @param[in] map The slot map
+ * @param[in] obj The object
+ *
+ * @return the handle, 0 if @a obj is not an allocated object of @a map
+ */
+mm_slotmap_handle_t mm_slotmap_handle(struct mm_slotmap *map, const void *obj);
+
+/**
+ * @brief Get the underlying pool of a slot map, for stats and iteration
+ *
+ * @param[in] map The slot map
+ *
+ * @return the pool, NULL otherwise
+ */
+struct mm_slab *mm_slotmap_slab(struct mm_slotmap *map);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -27,6 +27,7 @@
 
 #include <mm/track.h>
 #include <mm/alloc.h>
+#include <mm/shrinker.h>
 
 /* --------------------------------------------------------------------------
  * LOCAL CONSTANTS
@@ -191,6 +192,7 @@ void *__mm_realloc(void *ptr, size_t size, const char *file, int line)
 	uint32_t flags;
 	uint32_t sz;
 	uint32_t old_size = 0;
+	size_t usage;
 	bool should_count = (ptr == NULL);
 
 	sz = size;
@@ -222,10 +224,13 @@ void *__mm_realloc(void *ptr, size_t size, const char *file, int line)
 	_ctx.memtrack.allocated += (size - old_size);
 	if (_ctx.memtrack.allocated > _ctx.memtrack.max_allocated)
 		_ctx.memtrack.max_allocated = _ctx.memtrack.allocated;
+	usage = _ctx.memtrack.allocated;
 	if (!size) {
 		_ctx.memtrack.count -= 1;
 		IRQ_RESTORE(flags);
 
+		mm_shrinker_heap(usage);
+
 		if (info)
 			_thread_drop(&_ctx, info->size);
 
@@ -250,6 +255,9 @@ void *__mm_realloc(void *ptr, size_t size, const char *file, int line)
 		_ctx.memtrack.count++;
 	IRQ_RESTORE(flags);
 
+	/* Only recorded, the shrinkers run from mm_shrinker_poll() */
+	mm_shrinker_heap(usage);
+
 	return (struct _mt_info *)MT_GET_DATA(new_ptr);
 }
 
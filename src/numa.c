@@ -0,0 +1,180 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif /* __linux__ */
+
+#include <mm/numa.h>
+
+/* --------------------------------------------------------------------------
+ * LOCAL CONSTANTS
+ * -------------------------------------------------------------------------- */
+
+/* From <linux/mempolicy.h>, not relying on libnuma headers */
+#define _MPOL_PREFERRED 1
+#define _MPOL_BIND 2
+#define _MPOL_INTERLEAVE 3
+
+/* Nodes of the mbind() mask, one bit each */
+#define _NUMA_MAX_NODES (8 * sizeof(unsigned long))
+
+/* --------------------------------------------------------------------------
+ * LOCAL VARIABLES
+ * -------------------------------------------------------------------------- */
+
+#if defined(__linux__) && defined(SYS_mbind)
+/* Online nodes, read once from sysfs, 0 until then */
+static unsigned long _numa_online;
+#endif /* __linux__ && SYS_mbind */
+
+/* --------------------------------------------------------------------------
+ * LOCAL FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+#if defined(__linux__) && defined(SYS_mbind)
+/* Parse a sysfs node list such as "0-1,3" into a mask */
+static unsigned long _numa_read_online(void)
+{
+	unsigned long mask = 0;
+	char buf[128], *p;
+	FILE *f;
+
+	f = fopen("/sys/devices/system/node/online", "r");
+	if (!f)
+		return 1;
+
+	p = fgets(buf, sizeof(buf), f);
+	fclose(f);
+	if (!p)
+		return 1;
+
+	while (*p && *p != '\n') {
+		long first, last;
+		char *end;
+
+		first = strtol(p, &end, 10);
+		if (end == p)
+			break;
+
+		last = first;
+		if (*end == '-')
+			last = strtol(end + 1, &end, 10);
+
+		for (; first <= last && first < (long)_NUMA_MAX_NODES; first++)
+			mask |= 1ul << first;
+
+		p = (*end == ',') ? end + 1 : end;
+	}
+
+	return mask ? mask : 1;
+}
+
+/* Nodes do not come online while running, a racing first read is harmless */
+static unsigned long _numa_online_mask(void)
+{
+	unsigned long mask = __atomic_load_n(&_numa_online, __ATOMIC_RELAXED);
+
+	if (!mask) {
+		mask = _numa_read_online();
+		__atomic_store_n(&_numa_online, mask, __ATOMIC_RELAXED);
+	}
+
+	return mask;
+}
+#endif /* __linux__ && SYS_mbind */
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+int mm_numa_node_count(void)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+	return __builtin_popcountl(_numa_online_mask());
+#else
+	return 1;
+#endif /* __linux__ && SYS_mbind */
+}
+
+int mm_numa_current_node(void)
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+	unsigned int cpu, node;
+
+	if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+		return node;
+#endif /* __linux__ && SYS_getcpu */
+
+	return 0;
+}
+
+int mm_numa_apply(void *addr, size_t size, const struct mm_numa *numa)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+	unsigned long online, mask;
+	int mode, node;
+#endif /* __linux__ && SYS_mbind */
+	int count = mm_numa_node_count();
+
+	if (!addr || !size)
+		return -EINVAL;
+
+	if (!numa || numa->policy == MM_NUMA_DEFAULT)
+		return 0;
+
+	if (numa->policy == MM_NUMA_NODE && (numa->node < 0 || (size_t)numa->node >= _NUMA_MAX_NODES))
+		return -EINVAL;
+
+#if defined(__linux__) && defined(SYS_mbind)
+	online = _numa_online_mask();
+
+	switch (numa->policy) {
+	case MM_NUMA_LOCAL:
+		mode = _MPOL_PREFERRED;
+		node = mm_numa_current_node();
+		if (node < 0 || (size_t)node >= _NUMA_MAX_NODES)
+			return -EINVAL;
+		mask = 1ul << node;
+		break;
+	case MM_NUMA_NODE:
+		mode = _MPOL_BIND;
+		mask = 1ul << numa->node;
+		if (!(mask & online))
+			return -EINVAL;
+		break;
+	case MM_NUMA_INTERLEAVE:
+		mode = _MPOL_INTERLEAVE;
+		mask = online;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if (syscall(SYS_mbind, addr, size, mode, &mask, _NUMA_MAX_NODES + 1, 0) == 0)
+		return 0;
+
+	/* Kernel without NUMA support: a single node is the default placement */
+	if (count == 1 && (errno == ENOSYS || errno == EPERM))
+		return 0;
+
+	return -errno;
+#else
+	if (numa->policy == MM_NUMA_NODE && numa->node >= count)
+		return -EINVAL;
+
+	return 0;
+#endif /* __linux__ && SYS_mbind */
+}
@@ -0,0 +1,415 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif /* __unix__ */
+
+#include <mm/config/cdefs.h>
+#include <mm/config/config.h>
+
+#include <mm/alloc.h>
+#include <mm/page.h>
+
+/* --------------------------------------------------------------------------
+ * LOCAL FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+#if defined(__unix__)
+/* Map @a size bytes aligned on @a align by trimming an oversized mapping */
+static void *_page_map_aligned(size_t size, size_t align, int prot, int flags)
+{
+	uintptr_t start, aligned;
+	void *addr;
+
+	addr = mmap(NULL, size + align, prot, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+	if (addr == MAP_FAILED)
+		return NULL;
+
+	start = (uintptr_t)addr;
+	aligned = ROUNDUP(start, align);
+	if (aligned > start)
+		munmap(addr, aligned - start);
+	if (aligned < start + align)
+		munmap((void *)(aligned + size), start + align - aligned);
+
+	return (void *)aligned;
+}
+
+static void *_page_map(void *ctx, size_t *size, unsigned int flags)
+{
+	size_t len;
+	void *addr;
+
+	(void)ctx;
+
+	if (!size || !*size)
+		return NULL;
+
+	if (flags & MM_PAGE_F_HUGE) {
+		len = ROUNDUP(*size, MM_HUGEPAGE_SIZE);
+
+#if defined(MAP_HUGETLB)
+		/* Explicit huge pages, only if the system has reserved some */
+		addr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+			    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (addr != MAP_FAILED) {
+			*size = len;
+			return addr;
+		}
+#endif /* MAP_HUGETLB */
+
+		/* Transparent huge pages need a huge-page aligned region */
+		addr = _page_map_aligned(len, MM_HUGEPAGE_SIZE, PROT_READ | PROT_WRITE, 0);
+		if (addr) {
+#if defined(MADV_HUGEPAGE)
+			(void)madvise(addr, len, MADV_HUGEPAGE);
+#endif /* MADV_HUGEPAGE */
+			*size = len;
+			return addr;
+		}
+	}
+
+	len = ROUNDUP(*size, mm_page_size());
+	addr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED)
+		return NULL;
+
+	*size = len;
+	return addr;
+}
+
+static void _page_unmap(void *ctx, void *addr, size_t size)
+{
+	(void)ctx;
+
+	if (addr)
+		munmap(addr, size);
+}
+
+static int _page_release(void *ctx, void *addr, size_t size)
+{
+	(void)ctx;
+
+	if (madvise(addr, size, MADV_DONTNEED) < 0)
+		return -errno;
+
+	return 0;
+}
+
+/* Page faults taken so far by the calling thread (or process) */
+static size_t _page_faults(void)
+{
+	struct rusage usage;
+
+#if defined(RUSAGE_THREAD)
+	if (getrusage(RUSAGE_THREAD, &usage) == 0)
+		return usage.ru_minflt + usage.ru_majflt;
+#endif /* RUSAGE_THREAD */
+
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return usage.ru_minflt + usage.ru_majflt;
+
+	return 0;
+}
+#else
+/* No mmap(): page-aligned heap memory, the heap pointer is kept just before */
+static void *_page_map(void *ctx, size_t *size, unsigned int flags)
+{
+	size_t len, page = mm_page_size();
+	void *origin;
+	void **addr;
+
+	(void)ctx;
+	(void)flags;
+
+	if (!size || !*size)
+		return NULL;
+
+	len = ROUNDUP(*size, page);
+	origin = mm_malloc(len + page + sizeof(void *));
+	if (!origin)
+		return NULL;
+
+	addr = (void **)ROUNDUP((uintptr_t)origin + sizeof(void *), page);
+	addr[-1] = origin;
+
+	*size = len;
+	return addr;
+}
+
+static void _page_unmap(void *ctx, void *addr, size_t size)
+{
+	(void)ctx;
+	(void)size;
+
+	if (addr)
+		mm_free(((void **)addr)[-1]);
+}
+
+static int _page_release(void *ctx, void *addr, size_t size)
+{
+	(void)ctx;
+	(void)addr;
+	(void)size;
+
+	return -ENOTSUP;
+}
+
+static size_t _page_faults(void)
+{
+	return 0;
+}
+#endif /* __unix__ */
+
+/* --------------------------------------------------------------------------
+ * PUBLIC VARIABLES
+ * -------------------------------------------------------------------------- */
+
+const struct mm_page_provider mm_page_provider_default = {
+	.map = _page_map,
+	.unmap = _page_unmap,
+	.release = _page_release,
+	.ctx = NULL,
+};
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+size_t mm_page_size(void)
+{
+#if defined(__unix__)
+	long size = sysconf(_SC_PAGESIZE);
+
+	if (size > 0)
+		return size;
+#endif /* __unix__ */
+
+	return MM_PAGE_SIZE;
+}
+
+void *mm_page_map(size_t *size, unsigned int flags)
+{
+	return _page_map(NULL, size, flags);
+}
+
+int mm_page_unmap(void *addr, size_t size)
+{
+	if (!addr || !size)
+		return -EINVAL;
+
+	_page_unmap(NULL, addr, size);
+
+	return 0;
+}
+
+void *mm_page_reserve(size_t *size, size_t align, unsigned int flags)
+{
+#if defined(__unix__)
+	size_t page = mm_page_size();
+	void *addr;
+
+	if (!size || !*size || (align & (align - 1)))
+		return NULL;
+
+	if (align < page)
+		align = page;
+
+	*size = ROUNDUP(*size, page);
+	addr = _page_map_aligned(*size, align, PROT_NONE, MAP_NORESERVE);
+	if (!addr)
+		return NULL;
+
+#if defined(MADV_HUGEPAGE)
+	if (flags & MM_PAGE_F_HUGE)
+		(void)madvise(addr, *size, MADV_HUGEPAGE);
+#endif /* MADV_HUGEPAGE */
+
+	return addr;
+#else
+	(void)size;
+	(void)align;
+	(void)flags;
+
+	return NULL;
+#endif /* __unix__ */
+}
+
+int mm_page_commit(void *addr, size_t size)
+{
+#if defined(__unix__)
+	size_t page = mm_page_size();
+
+	if (!addr || !size || ((uintptr_t)addr % page) || (size % page))
+		return -EINVAL;
+
+	if (mprotect(addr, size, PROT_READ | PROT_WRITE) < 0)
+		return -errno;
+
+	return 0;
+#else
+	(void)addr;
+	(void)size;
+
+	return -ENOTSUP;
+#endif /* __unix__ */
+}
+
+int mm_page_decommit(void *addr, size_t size)
+{
+#if defined(__unix__)
+	size_t page = mm_page_size();
+
+	if (!addr || !size || ((uintptr_t)addr % page) || (size % page))
+		return -EINVAL;
+
+	if (madvise(addr, size, MADV_DONTNEED) < 0 || mprotect(addr, size, PROT_NONE) < 0)
+		return -errno;
+
+	return 0;
+#else
+	(void)addr;
+	(void)size;
+
+	return -ENOTSUP;
+#endif /* __unix__ */
+}
+
+int mm_page_release(void *addr, size_t size)
+{
+	size_t page = mm_page_size();
+
+	if (!addr || !size)
+		return -EINVAL;
+
+	if (((uintptr_t)addr % page) || (size % page))
+		return -EINVAL;
+
+	return _page_release(NULL, addr, size);
+}
+
+ssize_t mm_page_resident(void *addr, size_t size)
+{
+#if defined(__unix__)
+	size_t page = mm_page_size();
+	unsigned char vec[64];
+	uintptr_t p, end;
+	ssize_t bytes = 0;
+
+	if (!addr || !size)
+		return -EINVAL;
+
+	if (((uintptr_t)addr % page) || (size % page))
+		return -EINVAL;
+
+	end = (uintptr_t)addr + size;
+	for (p = (uintptr_t)addr; p < end; p += sizeof(vec) * page) {
+		size_t i, len = sizeof(vec) * page;
+
+		if (len > end - p)
+			len = end - p;
+
+		if (mincore((void *)p, len, vec) < 0)
+			return -errno;
+
+		for (i = 0; i < len / page; i++)
+			if (vec[i] & 1)
+				bytes += page;
+	}
+
+	return bytes;
+#else
+	(void)addr;
+	(void)size;
+
+	return -ENOTSUP;
+#endif /* __unix__ */
+}
+
+int mm_page_prefault(void *addr, size_t size, size_t *faults)
+{
+	size_t page = mm_page_size();
+	size_t before, touched = 0;
+	uintptr_t start, end, p;
+
+	if (!addr || !size)
+		return -EINVAL;
+
+	start = ROUNDUP((uintptr_t)addr, page);
+	end = (uintptr_t)addr + size;
+
+	before = _page_faults();
+
+	/*
+	 * Write back what is read, so that the page is not just mapped to the
+	 * zero page and the content of a reattached pool is kept
+	 */
+	if ((uintptr_t)addr < start) {
+		*(volatile uint8_t *)addr = *(volatile uint8_t *)addr;
+		touched++;
+	}
+	for (p = start; p < end; p += page) {
+		*(volatile uint8_t *)p = *(volatile uint8_t *)p;
+		touched++;
+	}
+
+	if (faults) {
+#if defined(__unix__)
+		*faults = _page_faults() - before;
+#else
+		(void)before;
+		*faults = touched;
+#endif /* __unix__ */
+	}
+
+	return 0;
+}
+
+int mm_page_lock(void *addr, size_t size)
+{
+#if defined(__unix__)
+	if (!addr || !size)
+		return -EINVAL;
+
+	if (mlock(addr, size) < 0)
+		return -errno;
+
+	return 0;
+#else
+	(void)addr;
+	(void)size;
+
+	return -ENOTSUP;
+#endif /* __unix__ */
+}
+
+int mm_page_unlock(void *addr, size_t size)
+{
+#if defined(__unix__)
+	if (!addr || !size)
+		return -EINVAL;
+
+	if (munlock(addr, size) < 0)
+		return -errno;
+
+	return 0;
+#else
+	(void)addr;
+	(void)size;
+
+	return -ENOTSUP;
+#endif /* __unix__ */
+}
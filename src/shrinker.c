@@ -0,0 +1,259 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <mm/config/config.h>
+#include <mm/config/mutex.h>
+
+#include <mm/shrinker.h>
+
+/* --------------------------------------------------------------------------
+ * INTERNAL TYPES
+ * -------------------------------------------------------------------------- */
+
+/* A source of memory pressure, armed again once below 7/8 of its threshold */
+struct _shrinker_watch {
+	atomic_size_t threshold;
+	atomic_bool armed;
+	atomic_size_t usage; /* Last usage reported, for the heap */
+};
+
+/* --------------------------------------------------------------------------
+ * LOCAL VARIABLES
+ * -------------------------------------------------------------------------- */
+
+static MUTEX_TYPE _shrinker_lock = MUTEX_INITIALIZER;
+static struct mm_shrinker *_shrinkers;
+static atomic_bool _shrinker_running;
+
+static struct _shrinker_watch _heap = {
+	.threshold = 0,
+	.armed = true,
+	.usage = 0,
+};
+
+static struct {
+	struct _shrinker_watch watch;
+	char path[PATH_MAX];
+	unsigned int percent;
+} _cgroup = {
+	.watch = { .threshold = 0, .armed = true, .usage = 0 },
+	.path = MM_CGROUP_PATH,
+	.percent = 0,
+};
+
+/* --------------------------------------------------------------------------
+ * LOCAL FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+static size_t _shrinker_low(size_t threshold)
+{
+	return threshold - threshold / 8;
+}
+
+static size_t _shrinker_check(struct _shrinker_watch *watch, size_t threshold, size_t usage)
+{
+	size_t low = _shrinker_low(threshold);
+
+	/*
+	 * The memory given back by the shrinkers does not count, or a cache
+	 * refilled right away would be shrunk over and over
+	 */
+	if (usage <= threshold) {
+		if (usage < low && !atomic_load(&_shrinker_running))
+			atomic_store_explicit(&watch->armed, true, memory_order_relaxed);
+		return 0;
+	}
+
+	if (!atomic_exchange_explicit(&watch->armed, false, memory_order_relaxed))
+		return 0;
+
+	return mm_shrink(usage - low);
+}
+
+/* Read a cgroup file holding a single value, -ENOENT for "max" */
+static int _cgroup_read(const char *dir, const char *name, size_t *value)
+{
+	char path[PATH_MAX + 32];
+	char buf[32];
+	ssize_t len;
+	int fd;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -errno;
+
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len <= 0)
+		return -EIO;
+	buf[len] = '\0';
+
+	if (!strncmp(buf, "max", 3))
+		return -ENOENT;
+
+	*value = strtoull(buf, NULL, 10);
+
+	return 0;
+}
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+int mm_shrinker_register(struct mm_shrinker *shrinker)
+{
+	if (!shrinker || !shrinker->count || !shrinker->scan)
+		return -EINVAL;
+
+	MUTEX_LOCK(_shrinker_lock);
+	shrinker->next = _shrinkers;
+	_shrinkers = shrinker;
+	MUTEX_UNLOCK(_shrinker_lock);
+
+	return 0;
+}
+
+int mm_shrinker_unregister(struct mm_shrinker *shrinker)
+{
+	struct mm_shrinker **s;
+	int err = -ENOENT;
+
+	if (!shrinker)
+		return -EINVAL;
+
+	MUTEX_LOCK(_shrinker_lock);
+	for (s = &_shrinkers; *s; s = &(*s)->next) {
+		if (*s == shrinker) {
+			*s = shrinker->next;
+			shrinker->next = NULL;
+			err = 0;
+			break;
+		}
+	}
+	MUTEX_UNLOCK(_shrinker_lock);
+
+	return err;
+}
+
+size_t mm_shrink(size_t target)
+{
+	struct mm_shrinker *s;
+	size_t total = 0, freed = 0;
+
+	/* Memory allocated or freed by the shrinkers must not run them again */
+	if (atomic_exchange(&_shrinker_running, true))
+		return 0;
+
+	MUTEX_LOCK(_shrinker_lock);
+
+	for (s = _shrinkers; s; s = s->next)
+		total += s->count(s->ctx);
+
+	for (s = _shrinkers; s && total && (!target || freed < target); s = s->next) {
+		size_t count = s->count(s->ctx);
+		size_t share = count;
+
+		if (!count)
+			continue;
+
+		/* Each cache gives back its part of the target, rounded up */
+		if (target && target < total) {
+			double part = (double)target * count / total;
+
+			share = (size_t)part;
+			if (share < part)
+				share++;
+		}
+
+		freed += s->scan(s->ctx, share);
+	}
+
+	MUTEX_UNLOCK(_shrinker_lock);
+
+	atomic_store(&_shrinker_running, false);
+
+	return freed;
+}
+
+void mm_shrinker_set_heap(size_t threshold)
+{
+	atomic_store_explicit(&_heap.threshold, threshold, memory_order_relaxed);
+	atomic_store_explicit(&_heap.armed, true, memory_order_relaxed);
+}
+
+void mm_shrinker_heap(size_t usage)
+{
+	size_t threshold = atomic_load_explicit(&_heap.threshold, memory_order_relaxed);
+
+	if (!threshold)
+		return;
+
+	/* Only recorded, the allocation paths never run the shrinkers */
+	atomic_store_explicit(&_heap.usage, usage, memory_order_relaxed);
+	if (usage < _shrinker_low(threshold) && !atomic_load(&_shrinker_running))
+		atomic_store_explicit(&_heap.armed, true, memory_order_relaxed);
+}
+
+int mm_shrinker_set_cgroup(const char *path, unsigned int percent)
+{
+	if (!path)
+		path = MM_CGROUP_PATH;
+
+	if (strlen(path) >= sizeof(_cgroup.path) || percent > 100)
+		return -EINVAL;
+
+	MUTEX_LOCK(_shrinker_lock);
+	strcpy(_cgroup.path, path);
+	_cgroup.percent = percent;
+	atomic_store_explicit(&_cgroup.watch.armed, true, memory_order_relaxed);
+	MUTEX_UNLOCK(_shrinker_lock);
+
+	return 0;
+}
+
+ssize_t mm_shrinker_poll(void)
+{
+	size_t threshold, usage, limit, freed = 0;
+	char dir[PATH_MAX];
+	unsigned int percent;
+	int err;
+
+	threshold = atomic_load_explicit(&_heap.threshold, memory_order_relaxed);
+	if (threshold)
+		freed = _shrinker_check(&_heap, threshold,
+					atomic_load_explicit(&_heap.usage, memory_order_relaxed));
+
+	/* Files are read and shrinkers run without the registry lock */
+	MUTEX_LOCK(_shrinker_lock);
+	percent = _cgroup.percent;
+	if (percent)
+		strcpy(dir, _cgroup.path);
+	MUTEX_UNLOCK(_shrinker_lock);
+
+	if (!percent)
+		return freed;
+
+	err = _cgroup_read(dir, "memory.current", &usage);
+	if (!err)
+		err = _cgroup_read(dir, "memory.max", &limit);
+	if (err < 0)
+		return freed ? (ssize_t)freed : err;
+
+	return freed + _shrinker_check(&_cgroup.watch, limit / 100 * percent, usage);
+}
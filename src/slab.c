@@ -9,14 +9,26 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <freebsd/sys/sys/bitcount.h>
 #include <freebsd/sys/sys/bitstring.h>
 
 #include <mm/config/cdefs.h>
+#include <mm/config/config.h>
 #include <mm/config/mutex.h>
 
+#if defined(__unix__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* __unix__ */
+
 #include <mm/alloc.h>
+#include <mm/numa.h>
+#include <mm/page.h>
 #include <mm/slab.h>
 
 /* --------------------------------------------------------------------------
@@ -26,86 +38,713 @@
 /* SLAB in hexadecimal */
 #define MM_SLAB_MAGIC 0x83766566
 
+/* How a pointer offset is turned into an element index */
+#define _MM_SLAB_DIV_SHIFT 0
+#define _MM_SLAB_DIV_RECIPROCAL 1
+#define _MM_SLAB_DIV_DIVIDE 2
+
+/* Descriptor and bitmap are not owned by the slab */
+#define _MM_SLAB_STATIC_DESC (1u << 0)
+#define _MM_SLAB_STATIC_BITMAP (1u << 1)
+/* Pool mapped from a file, and reattached to its previous content */
+#define _MM_SLAB_FILE (1u << 2)
+#define _MM_SLAB_ATTACHED (1u << 3)
+
+/* SLBF in ascii */
+#define MM_SLAB_FILE_MAGIC 0x534c4246
+#define MM_SLAB_FILE_VERSION 1
+
+/* Header of a file-backed pool, locations are offsets from the file start */
+struct _slab_file {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t esize;
+	uint64_t ecount;
+	uint64_t alignment;
+	uint64_t bitmap;
+	uint64_t pool;
+	uint64_t size;
+};
+
 struct mm_slab {
 	uint32_t magic;
+	unsigned int flags;
 	void *pool;
 	void *pool_origin;
+	size_t pool_size;
+	const struct mm_page_provider *provider;
+	int fd;
 	size_t alignment;
 	size_t esize;
+	size_t stride;
 	size_t ecount;
+	size_t span;
+	int div; /* _MM_SLAB_DIV_* */
+	unsigned int shift;
+	uint64_t reciprocal;
 	MUTEX_TYPE lock;
 
+	mm_slab_ctor_t ctor;
+	mm_slab_dtor_t dtor;
+	mm_slab_relocate_t relocate;
+	void *ctx;
+
+	bitstr_t *allocated;
+
+	struct {
+		size_t prefaulted;
+		size_t faults;
+		size_t locked;
+	} mem;
+
+	/* Readers do not take the lock: keep them off the allocation state */
+	unsigned char pad[MM_CACHELINE_SIZE];
+
+	/* Written with the lock held, read without it (see _SLAB_STAT_*) */
 	struct {
 		size_t allocated;
 		size_t missed;
 		size_t freed;
+		size_t inuse;
+		size_t hwm;
+		size_t searched;
 	} stats;
-
-	bitstr_t *allocated;
 };
 
+_Static_assert(sizeof(struct mm_slab) <= sizeof(struct mm_slab_storage),
+	       "MM_SLAB_STORAGE_SIZE is too small for struct mm_slab");
+_Static_assert(_Alignof(struct mm_slab) <= _Alignof(struct mm_slab_storage),
+	       "struct mm_slab_storage is not aligned enough for struct mm_slab");
+
+/* Stats updates need no atomic read-modify-write, only untorn accesses */
+#define _SLAB_STAT_READ(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#define _SLAB_STAT_ADD(field, n) \
+	__atomic_store_n(&(field), (field) + (n), __ATOMIC_RELAXED)
+#define _SLAB_STAT_SUB(field, n) \
+	__atomic_store_n(&(field), (field) - (n), __ATOMIC_RELAXED)
+
+/* --------------------------------------------------------------------------
+ * LOCAL VARIABLES
+ * -------------------------------------------------------------------------- */
+
+static unsigned int _slab_colour_next;
+
+/* --------------------------------------------------------------------------
+ * LOCAL FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+/* Account @a n more elements in use, called with the lock held */
+static inline void _slab_inuse(struct mm_slab *slab, size_t n)
+{
+	_SLAB_STAT_ADD(slab->stats.inuse, n);
+	if (slab->stats.inuse > slab->stats.hwm)
+		_SLAB_STAT_ADD(slab->stats.hwm, slab->stats.inuse - slab->stats.hwm);
+}
+
+static inline void *_slab_obj(struct mm_slab *slab, size_t idx)
+{
+	return (void *)((uintptr_t)slab->pool + idx * slab->stride);
+}
+
+/*
+ * Pick the colour of a new pool: returns the offset of the first element and
+ * may widen the stride. @a room is the number of bytes available past
+ * ecount * stride, or SIZE_MAX when the pool is allocated here.
+ */
+static size_t _slab_colour(struct mm_slab *slab, size_t room)
+{
+	size_t colour, ncolours, offset;
+
+	colour = MM_CACHELINE_SIZE;
+	if (slab->alignment)
+		colour = ROUNDUP(colour, slab->alignment);
+
+	if (colour >= MM_COLOUR_SPAN)
+		return 0;
+
+	/* Every element would share the same cache set */
+	if (!(slab->stride % MM_COLOUR_SPAN) && room / slab->ecount >= colour) {
+		slab->stride += colour;
+		if (room != SIZE_MAX)
+			room -= colour * slab->ecount;
+	}
+
+	ncolours = MM_COLOUR_SPAN / colour;
+	offset = (__atomic_fetch_add(&_slab_colour_next, 1, __ATOMIC_RELAXED) % ncolours) * colour;
+	while (offset > room)
+		offset -= colour;
+
+	return offset;
+}
+
+/*
+ * Precompute the division by the stride: a shift for powers of two, otherwise
+ * a 64-bit reciprocal (Lemire et al., "Faster Remainder by Direct Computation")
+ * exact for 32-bit offsets, which also tells if the offset is a multiple.
+ */
+static void _slab_divider(struct mm_slab *slab)
+{
+	slab->span = slab->stride * slab->ecount;
+
+	if (ISPOWEROF2(slab->stride)) {
+		slab->div = _MM_SLAB_DIV_SHIFT;
+		slab->shift = __builtin_ctzl(slab->stride);
+	} else if (slab->span <= UINT32_MAX) {
+		slab->div = _MM_SLAB_DIV_RECIPROCAL;
+		slab->reciprocal = UINT64_MAX / slab->stride + 1;
+	} else {
+		slab->div = _MM_SLAB_DIV_DIVIDE;
+	}
+}
+
+/* Upper 64 bits of a 64x32 bit product, with 64-bit multiplications only */
+static inline uint64_t _slab_mulhi(uint64_t a, uint32_t b)
+{
+	uint64_t lo = (a & UINT32_MAX) * b;
+	uint64_t hi = (a >> 32) * b;
+
+	return (hi + (lo >> 32)) >> 32;
+}
+
+/* Index of the element at @a ptr, a negative value if it is not one */
+static inline ssize_t _slab_index(const struct mm_slab *slab, const void *ptr)
+{
+	uintptr_t off = (uintptr_t)ptr - (uintptr_t)slab->pool;
+
+	/* Wraps around when ptr is below the pool */
+	if (off >= slab->span)
+		return -ERANGE;
+
+	switch (slab->div) {
+	case _MM_SLAB_DIV_SHIFT:
+		if (off & (slab->stride - 1))
+			return -EINVAL;
+		return off >> slab->shift;
+	case _MM_SLAB_DIV_RECIPROCAL:
+		if (slab->reciprocal * off > slab->reciprocal - 1)
+			return -EINVAL;
+		return _slab_mulhi(slab->reciprocal, off);
+	default:
+		if (off % slab->stride)
+			return -EINVAL;
+		return off / slab->stride;
+	}
+}
+
+static void *_slab_pool_alloc(struct mm_slab *slab, const struct mm_slab_config *config, size_t size)
+{
+	unsigned int flags = 0;
+	void *pool;
+
+	if (!slab->provider)
+		return mm_malloc(size);
+
+	if (config->flags & MM_SLAB_F_HUGEPAGE)
+		flags |= MM_PAGE_F_HUGE;
+
+	slab->pool_size = size;
+
+	pool = slab->provider->map(slab->provider->ctx, &slab->pool_size, flags);
+	if (!pool)
+		return NULL;
+
+	/* Placement must be set before the first touch of the pages */
+	if (mm_numa_apply(pool, slab->pool_size, &config->numa) < 0) {
+		slab->provider->unmap(slab->provider->ctx, pool, slab->pool_size);
+		return NULL;
+	}
+
+	return pool;
+}
+
+static void _slab_pool_free(struct mm_slab *slab)
+{
+	if (!slab->pool_origin)
+		return;
+
+#if defined(__unix__)
+	if (slab->flags & _MM_SLAB_FILE) {
+		munmap(slab->pool_origin, slab->pool_size);
+		close(slab->fd);
+		return;
+	}
+#endif /* __unix__ */
+
+	if (slab->provider)
+		slab->provider->unmap(slab->provider->ctx, slab->pool_origin, slab->pool_size);
+	else
+		mm_free(slab->pool_origin);
+}
+
+static void _slab_destruct(struct mm_slab *slab, size_t count)
+{
+	size_t i;
+
+	if (!slab->dtor)
+		return;
+
+	for (i = 0; i < count; i++)
+		slab->dtor(_slab_obj(slab, i), slab->ctx);
+}
+
+/* Objects are constructed once, when the backing memory is set up */
+static int _slab_construct(struct mm_slab *slab)
+{
+	size_t i;
+	int err;
+
+	if (!slab->ctor)
+		return 0;
+
+	for (i = 0; i < slab->ecount; i++) {
+		err = slab->ctor(_slab_obj(slab, i), slab->ctx);
+		if (err < 0) {
+			_slab_destruct(slab, i);
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+/* Last allocated element below @a limit, -1 if none */
+static ssize_t _slab_last_below(struct mm_slab *slab, size_t limit)
+{
+	ssize_t w;
+
+	if (!limit)
+		return -1;
+
+	for (w = _bit_idx(limit - 1); w >= 0; w--) {
+		bitstr_t live = slab->allocated[w];
+
+		if ((size_t)w == _bit_idx(limit - 1))
+			live &= _bit_make_mask(0, _bit_offset(limit - 1));
+
+		if (live)
+			return w * _BITSTR_BITS + (_BITSTR_BITS - 1 - __builtin_clzl(live));
+	}
+
+	return -1;
+}
+
+static int _slab_page_release(struct mm_slab *slab, uintptr_t addr, size_t size)
+{
+	if (!slab->provider)
+		return mm_page_release((void *)addr, size);
+
+	if (!slab->provider->release)
+		return -ENOTSUP;
+
+	return slab->provider->release(slab->provider->ctx, (void *)addr, size);
+}
+
+/*
+ * Give back every run of pages without any live element, called with the
+ * lock held so that no element of those pages can be allocated meanwhile.
+ * Constructed elements would lose their state: pools with a constructor keep
+ * their pages, as do user buffers. Only resident bytes are counted, and the
+ * scan stops once @a limit of them are given back (0 for no limit).
+ */
+static size_t _slab_release_free(struct mm_slab *slab, size_t limit)
+{
+	uintptr_t pool = (uintptr_t)slab->pool;
+	uintptr_t addr, start, end;
+	size_t page = mm_page_size();
+	size_t bytes = 0;
+
+	if (slab->ctor || !slab->pool_origin || !slab->allocated)
+		return 0;
+
+	/*
+	 * Dropping pages of a shared file mapping gives nothing back, and
+	 * locked pages are meant to stay
+	 */
+	if ((slab->flags & _MM_SLAB_FILE) || slab->mem.locked)
+		return 0;
+
+	start = ROUNDUP(pool, page);
+	end = ((pool + slab->span) / page) * page;
+
+	addr = start;
+	while (addr < end && (!limit || bytes < limit)) {
+		uintptr_t run, next = end;
+		ssize_t resident;
+
+		for (run = addr; run < end; run += page) {
+			size_t first = (run - pool) / slab->stride;
+			size_t last = (run + page - 1 - pool) / slab->stride;
+
+			/* The page holding a live element is skipped */
+			if (!bit_ntest(slab->allocated, first, last, 0)) {
+				next = run + page;
+				break;
+			}
+
+			if (limit && run + page - addr >= limit - bytes) {
+				run += page;
+				next = run;
+				break;
+			}
+		}
+
+		if (run > addr) {
+			/* Pages given back earlier are not counted (nor released) again */
+			resident = mm_page_resident((void *)addr, run - addr);
+			if (resident < 0)
+				resident = run - addr;
+
+			if (resident && _slab_page_release(slab, addr, run - addr) == 0)
+				bytes += resident;
+		}
+
+		addr = next;
+	}
+
+	return bytes;
+}
+
+static void _slab_unlock(struct mm_slab *slab)
+{
+	if (!slab->mem.locked)
+		return;
+
+	(void)mm_page_unlock(slab->pool, slab->mem.locked);
+	slab->mem.locked = 0;
+}
+
+/* Fault in and lock the pool, before the constructor touches it */
+static int _slab_resident(struct mm_slab *slab, unsigned int flags)
+{
+	size_t size = slab->ecount * slab->stride;
+	int err;
+
+	if (!(flags & (MM_SLAB_F_PREFAULT | MM_SLAB_F_MLOCK)))
+		return 0;
+
+	if (flags & MM_SLAB_F_MLOCK) {
+		err = mm_page_lock(slab->pool, size);
+		if (err < 0)
+			return err;
+
+		slab->mem.locked = size;
+	}
+
+	err = mm_page_prefault(slab->pool, size, &slab->mem.faults);
+	if (err < 0) {
+		_slab_unlock(slab);
+		return err;
+	}
+
+	slab->mem.prefaulted = size;
+
+	return 0;
+}
+
+static bool _slab_config_valid(const struct mm_slab_config *config)
+{
+	if (!config || !config->esize || !config->ecount)
+		return false;
+
+	if (config->alignment && !ISPOWEROF2(config->alignment))
+		return false;
+
+	return true;
+}
+
+/* Set up a descriptor whose memory and bitmap (zeroed) are given by the caller */
+static int _slab_setup(struct mm_slab *slab, const struct mm_slab_config *config,
+		       bitstr_t *bitmap, unsigned int flags)
+{
+	size_t alignment = config->alignment;
+	int err;
+
+	err = MUTEX_INIT(slab->lock);
+	if (err < 0)
+		return err;
+
+	slab->magic = MM_SLAB_MAGIC;
+	slab->flags = flags;
+	slab->ecount = config->ecount;
+	slab->allocated = bitmap;
+	slab->pool = NULL;
+	slab->pool_origin = NULL;
+	slab->pool_size = 0;
+	slab->provider = NULL;
+	slab->fd = -1;
+	slab->alignment = alignment;
+	slab->esize = config->esize;
+	slab->stride = config->esize;
+	slab->ctor = config->ctor;
+	slab->dtor = config->dtor;
+	slab->relocate = config->relocate;
+	slab->ctx = config->ctx;
+	slab->mem.prefaulted = 0;
+	slab->mem.faults = 0;
+	slab->mem.locked = 0;
+	memset(&slab->stats, 0, sizeof(slab->stats));
+
+	if (config->buffer) {
+		size_t offset = 0;
+
+		if ((config->flags & MM_SLAB_F_COLOUR) && config->size > slab->esize * slab->ecount)
+			offset = _slab_colour(slab, config->size - slab->esize * slab->ecount);
+
+		slab->pool = (void *)((uintptr_t)config->buffer + offset);
+	} else {
+		size_t offset = 0;
+
+		if (alignment)
+			slab->esize = ROUNDUP(slab->esize, alignment);
+		slab->stride = slab->esize;
+
+		if (config->flags & MM_SLAB_F_COLOUR)
+			offset = _slab_colour(slab, SIZE_MAX);
+
+		if (config->provider)
+			slab->provider = config->provider;
+		else if ((config->flags & (MM_SLAB_F_PAGES | MM_SLAB_F_HUGEPAGE)) ||
+			 config->numa.policy != MM_NUMA_DEFAULT)
+			slab->provider = &mm_page_provider_default;
+
+		slab->pool_origin = _slab_pool_alloc(slab, config, slab->ecount * slab->stride + alignment + offset);
+		if (!slab->pool_origin) {
+			MUTEX_DESTROY(slab->lock);
+			slab->magic = 0;
+			return -ENOMEM;
+		}
+
+		if (alignment)
+			slab->pool = (void *)ROUNDUP(((uintptr_t)slab->pool_origin), alignment);
+		else
+			slab->pool = slab->pool_origin;
+		slab->pool = (void *)((uintptr_t)slab->pool + offset);
+	}
+
+	_slab_divider(slab);
+
+	err = _slab_resident(slab, config->flags);
+	if (err < 0)
+		goto err_pool;
+
+	/* Reattached elements were constructed by a previous owner */
+	if (flags & _MM_SLAB_ATTACHED) {
+		size_t inuse;
+
+		bit_count(slab->allocated, 0, slab->ecount, &inuse);
+		_slab_inuse(slab, inuse);
+		return 0;
+	}
+
+	err = _slab_construct(slab);
+	if (err < 0)
+		goto err_unlock;
+
+	return 0;
+
+err_unlock:
+	_slab_unlock(slab);
+err_pool:
+	_slab_pool_free(slab);
+	MUTEX_DESTROY(slab->lock);
+	slab->magic = 0;
+	return err;
+}
+
+#if defined(__unix__)
+/*
+ * Map the pool from a file laid out as header, bitmap then elements. A file
+ * holding a complete pool with the same geometry is reattached as is, an empty
+ * (or never completed) one is initialised.
+ */
+static struct mm_slab *_slab_create_file(const struct mm_slab_config *config)
+{
+	struct mm_slab_config pool_config;
+	struct _slab_file *hdr;
+	size_t esize, bitmap, pool, size;
+	unsigned int flags = _MM_SLAB_STATIC_BITMAP | _MM_SLAB_FILE;
+	struct mm_slab *slab;
+	struct stat st;
+	void *base;
+	int fd, err;
+
+	esize = config->esize;
+	if (config->alignment)
+		esize = ROUNDUP(esize, config->alignment);
+
+	bitmap = ROUNDUP(sizeof(struct _slab_file), sizeof(bitstr_t));
+	pool = bitmap + bitstr_size(config->ecount);
+	pool = ROUNDUP(pool, config->alignment ? config->alignment : sizeof(bitstr_t));
+	size = ROUNDUP(pool + esize * config->ecount, mm_page_size());
+
+	fd = open(config->path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (fd < 0)
+		return NULL;
+
+	/* A pool has a single owner at a time */
+	if (flock(fd, LOCK_EX | LOCK_NB) < 0 || fstat(fd, &st) < 0)
+		goto err_close;
+
+	if (st.st_size && (size_t)st.st_size != size)
+		goto err_close;
+
+	if (!st.st_size && ftruncate(fd, size) < 0)
+		goto err_close;
+
+	base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED)
+		goto err_close;
+
+	hdr = base;
+	if (hdr->magic == MM_SLAB_FILE_MAGIC) {
+		if (hdr->version != MM_SLAB_FILE_VERSION || hdr->esize != esize ||
+		    hdr->ecount != config->ecount || hdr->alignment != config->alignment ||
+		    hdr->bitmap != bitmap || hdr->pool != pool || hdr->size != size)
+			goto err_unmap;
+
+		flags |= _MM_SLAB_ATTACHED;
+	} else {
+		memset(base, 0, pool);
+		hdr->version = MM_SLAB_FILE_VERSION;
+		hdr->esize = esize;
+		hdr->ecount = config->ecount;
+		hdr->alignment = config->alignment;
+		hdr->bitmap = bitmap;
+		hdr->pool = pool;
+		hdr->size = size;
+	}
+
+	slab = mm_malloc(sizeof(struct mm_slab));
+	if (!slab)
+		goto err_unmap;
+
+	pool_config = *config;
+	pool_config.buffer = (void *)((uintptr_t)base + pool);
+	pool_config.size = esize * config->ecount;
+	pool_config.esize = esize;
+
+	err = _slab_setup(slab, &pool_config, (bitstr_t *)((uintptr_t)base + bitmap), flags);
+	if (err < 0) {
+		mm_free(slab);
+		goto err_unmap;
+	}
+
+	slab->pool_origin = base;
+	slab->pool_size = size;
+	slab->fd = fd;
+
+	/* Marked complete once every element is constructed */
+	hdr->magic = MM_SLAB_FILE_MAGIC;
+
+	return slab;
+
+err_unmap:
+	munmap(base, size);
+err_close:
+	close(fd);
+	return NULL;
+}
+#else
+static struct mm_slab *_slab_create_file(const struct mm_slab_config *config)
+{
+	(void)config;
+
+	return NULL;
+}
+#endif /* __unix__ */
+
 /* --------------------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------------------- */
 
 struct mm_slab *mm_slab_create(void *buffer, size_t alignment, size_t esize, size_t ecount)
+{
+	struct mm_slab_config config = {
+		.buffer = buffer,
+		.alignment = alignment,
+		.esize = esize,
+		.ecount = ecount,
+	};
+
+	return mm_slab_create_config(&config);
+}
+
+struct mm_slab *mm_slab_create_config(const struct mm_slab_config *config)
 {
 	struct mm_slab *slab;
+	bitstr_t *bitmap;
 	int err;
 
-	if (!esize || !ecount)
+	if (!_slab_config_valid(config))
 		return NULL;
 
-	if (alignment && !ISPOWEROF2(alignment))
-		return NULL;
+	if (config->path)
+		return _slab_create_file(config);
 
 	slab = mm_malloc(sizeof(struct mm_slab));
-	slab->magic = MM_SLAB_MAGIC;
+	if (!slab)
+		return NULL;
 
-	err = MUTEX_INIT(slab->lock);
-	if (err < 0) {
+	bitmap = bit_alloc(config->ecount);
+	if (!bitmap) {
 		mm_free(slab);
 		return NULL;
 	}
 
-	slab->ecount = ecount;
-
-	slab->allocated = bit_alloc(slab->ecount);
-	if (!slab->allocated) {
-		MUTEX_DESTROY(slab->lock);
+	err = _slab_setup(slab, config, bitmap, 0);
+	if (err < 0) {
+		mm_free(bitmap);
 		mm_free(slab);
 		return NULL;
 	}
 
-	slab->pool = NULL;
-	slab->pool_origin = NULL;
-	slab->alignment = alignment;
-	slab->esize = esize;
-	slab->stats.allocated = 0;
-	slab->stats.missed = 0;
-	slab->stats.freed = 0;
+	return slab;
+}
 
-	if (buffer) {
-		slab->pool = buffer;
+struct mm_slab *mm_slab_init(struct mm_slab_storage *storage, const struct mm_slab_config *config)
+{
+	struct mm_slab_config pool_config;
+	uintptr_t cursor, end;
+	struct mm_slab *slab;
+	unsigned int flags = _MM_SLAB_STATIC_BITMAP;
+	bitstr_t *bitmap;
+	int err;
 
-		return slab;
+	if (!_slab_config_valid(config) || !config->buffer || !config->size || config->path)
+		return NULL;
+
+	cursor = (uintptr_t)config->buffer;
+	end = cursor + config->size;
+
+	if (storage) {
+		slab = (struct mm_slab *)storage;
+	} else {
+		cursor = ROUNDUP(cursor, _Alignof(struct mm_slab));
+		slab = (struct mm_slab *)cursor;
+		cursor += sizeof(struct mm_slab);
 	}
+	flags |= _MM_SLAB_STATIC_DESC;
 
-	if (alignment)
-		slab->esize = ROUNDUP(esize, alignment);
+	/* The bitmap sits right before the elements */
+	cursor = ROUNDUP(cursor, sizeof(bitstr_t));
+	bitmap = (bitstr_t *)cursor;
+	cursor += bitstr_size(config->ecount);
 
-	slab->pool_origin = mm_malloc(ecount * slab->esize + alignment);
-	if (!slab->pool_origin) {
-		mm_free(slab->allocated);
-		MUTEX_DESTROY(slab->lock);
-		mm_free(slab);
+	if (config->alignment)
+		cursor = ROUNDUP(cursor, config->alignment);
+
+	if (cursor > end || end - cursor < config->esize * config->ecount)
 		return NULL;
-	}
 
-	if (alignment)
-		slab->pool = (void *)ROUNDUP(((uintptr_t)slab->pool_origin), alignment);
-	else
-		slab->pool = slab->pool_origin;
+	memset(bitmap, 0, bitstr_size(config->ecount));
+
+	pool_config = *config;
+	pool_config.buffer = (void *)cursor;
+	pool_config.size = end - cursor;
+
+	err = _slab_setup(slab, &pool_config, bitmap, flags);
+	if (err < 0)
+		return NULL;
 
 	return slab;
 }
@@ -118,6 +757,16 @@ int mm_slab_destroy(struct mm_slab *slab)
 	if (slab->magic != MM_SLAB_MAGIC)
 		return -EIO;
 
+	/* Persistent elements outlive the process, they are only detached */
+	if (slab->flags & _MM_SLAB_FILE) {
+		_slab_unlock(slab);
+		_slab_pool_free(slab);
+		MUTEX_DESTROY(slab->lock);
+		slab->magic = 0;
+		mm_free(slab);
+		return 0;
+	}
+
 	if (slab->allocated) {
 		size_t count;
 
@@ -125,14 +774,19 @@ int mm_slab_destroy(struct mm_slab *slab)
 		if (count)
 			return -EAGAIN;
 
-		mm_free(slab->allocated);
+		if (!(slab->flags & _MM_SLAB_STATIC_BITMAP))
+			mm_free(slab->allocated);
 	}
 
-	if (slab->pool_origin)
-		mm_free(slab->pool_origin);
+	_slab_destruct(slab, slab->ecount);
+
+	_slab_unlock(slab);
+	_slab_pool_free(slab);
 
 	MUTEX_DESTROY(slab->lock);
-	mm_free(slab);
+	slab->magic = 0;
+	if (!(slab->flags & _MM_SLAB_STATIC_DESC))
+		mm_free(slab);
 
 	return 0;
 }
@@ -154,13 +808,16 @@ void *mm_slab_alloc(struct mm_slab *slab)
 
 	MUTEX_LOCK(slab->lock);
 	bit_ffc(slab->allocated, slab->ecount, &idx);
-	if (idx <= slab->ecount) {
-		ptr = (void *)((uintptr_t)slab->pool + idx * slab->esize);
+	if (idx >= 0) {
+		ptr = _slab_obj(slab, idx);
 		bit_set(slab->allocated, idx);
-		slab->stats.allocated++;
+		_SLAB_STAT_ADD(slab->stats.allocated, 1);
+		_slab_inuse(slab, 1);
+		_SLAB_STAT_ADD(slab->stats.searched, _bit_idx(idx) + 1);
 	} else {
 		ptr = NULL;
-		slab->stats.missed++;
+		_SLAB_STAT_ADD(slab->stats.missed, 1);
+		_SLAB_STAT_ADD(slab->stats.searched, _bit_idx(slab->ecount - 1) + 1);
 	}
 	MUTEX_UNLOCK(slab->lock);
 
@@ -169,7 +826,7 @@ void *mm_slab_alloc(struct mm_slab *slab)
 
 int mm_slab_free(struct mm_slab *slab, void *ptr)
 {
-	size_t idx;
+	ssize_t idx;
 
 	if (!slab || !ptr)
 		return -EINVAL;
@@ -177,19 +834,319 @@ int mm_slab_free(struct mm_slab *slab, void *ptr)
 	if (slab->magic != MM_SLAB_MAGIC)
 		return -EIO;
 
+	/* The pool geometry never changes, no need to hold the lock */
+	idx = _slab_index(slab, ptr);
+	if (idx < 0)
+		return idx;
+
+	MUTEX_LOCK(slab->lock);
+	if (slab->allocated && bit_test(slab->allocated, idx)) {
+		bit_clear(slab->allocated, idx);
+		_SLAB_STAT_SUB(slab->stats.inuse, 1);
+	}
+	_SLAB_STAT_ADD(slab->stats.freed, 1);
+	MUTEX_UNLOCK(slab->lock);
+
+	return 0;
+}
+
+int mm_slab_alloc_bulk(struct mm_slab *slab, void **ptrs, size_t n)
+{
+	size_t w, nwords, count = 0;
+
+	if (!slab || !ptrs)
+		return -EINVAL;
+
+	if (slab->magic != MM_SLAB_MAGIC)
+		return -EIO;
+
+	if (!slab->allocated)
+		return -EINVAL;
+
+	nwords = _bit_idx(slab->ecount - 1) + 1;
+
+	MUTEX_LOCK(slab->lock);
+	for (w = 0; w < nwords && count < n; w++) {
+		bitstr_t avail, taken = 0;
+
+		avail = ~slab->allocated[w];
+		if (w == nwords - 1)
+			avail &= _bit_make_mask(0, _bit_offset(slab->ecount - 1));
+
+		while (avail && count < n) {
+			size_t bit = ffsl(avail) - 1;
+
+			avail &= avail - 1;
+			taken |= _bit_mask(bit);
+			ptrs[count++] = _slab_obj(slab, w * _BITSTR_BITS + bit);
+		}
+
+		slab->allocated[w] |= taken;
+	}
+	_SLAB_STAT_ADD(slab->stats.allocated, count);
+	_SLAB_STAT_ADD(slab->stats.missed, n - count);
+	_SLAB_STAT_ADD(slab->stats.searched, w);
+	_slab_inuse(slab, count);
+	MUTEX_UNLOCK(slab->lock);
+
+	return count;
+}
+
+int mm_slab_free_bulk(struct mm_slab *slab, void **ptrs, size_t n)
+{
+	size_t i, w = 0;
+	bitstr_t mask = 0;
+
+	if (!slab || !ptrs)
+		return -EINVAL;
+
+	if (slab->magic != MM_SLAB_MAGIC)
+		return -EIO;
+
+	for (i = 0; i < n; i++) {
+		ssize_t idx;
+
+		if (!ptrs[i])
+			return -EINVAL;
+
+		idx = _slab_index(slab, ptrs[i]);
+		if (idx < 0)
+			return idx;
+	}
+
 	MUTEX_LOCK(slab->lock);
-	if (((uintptr_t)ptr < (uintptr_t)slab->pool) || ((uintptr_t)ptr > (uintptr_t)slab->pool + slab->esize * slab->ecount)) {
+	if (slab->allocated) {
+		size_t cleared = 0;
+
+		/* Gather the bits per bitmap word, frees are often batched by word */
+		for (i = 0; i < n; i++) {
+			size_t idx = _slab_index(slab, ptrs[i]);
+
+			if (mask && _bit_idx(idx) != w) {
+				cleared += __bitcountl(slab->allocated[w] & mask);
+				slab->allocated[w] &= ~mask;
+				mask = 0;
+			}
+
+			w = _bit_idx(idx);
+			mask |= _bit_mask(idx);
+		}
+
+		if (mask) {
+			cleared += __bitcountl(slab->allocated[w] & mask);
+			slab->allocated[w] &= ~mask;
+		}
+
+		_SLAB_STAT_SUB(slab->stats.inuse, cleared);
+	}
+	_SLAB_STAT_ADD(slab->stats.freed, n);
+	MUTEX_UNLOCK(slab->lock);
+
+	return 0;
+}
+
+int mm_slab_foreach(struct mm_slab *slab, mm_slab_foreach_t cb, void *ctx)
+{
+	size_t w, nwords;
+
+	if (!slab || !cb)
+		return -EINVAL;
+
+	if (slab->magic != MM_SLAB_MAGIC)
+		return -EIO;
+
+	if (!slab->allocated)
+		return -EINVAL;
+
+	nwords = _bit_idx(slab->ecount - 1) + 1;
+	for (w = 0; w < nwords; w++) {
+		bitstr_t live;
+
+		MUTEX_LOCK(slab->lock);
+		live = slab->allocated[w];
 		MUTEX_UNLOCK(slab->lock);
-		return -ERANGE;
+
+		while (live) {
+			size_t bit = ffsl(live) - 1;
+			int ret;
+
+			live &= live - 1;
+			ret = cb(_slab_obj(slab, w * _BITSTR_BITS + bit), ctx);
+			if (ret)
+				return ret;
+		}
 	}
 
-	idx = ((uintptr_t)ptr - (uintptr_t)slab->pool) / slab->esize;
+	return 0;
+}
 
-	if (slab->allocated)
-		bit_clear(slab->allocated, idx);
-	slab->stats.freed++;
+int mm_slab_compact(struct mm_slab *slab, size_t *moved, size_t *released)
+{
+	size_t limit, count = 0, bytes;
+
+	if (!slab)
+		return -EINVAL;
+
+	if (slab->magic != MM_SLAB_MAGIC)
+		return -EIO;
+
+	if (!slab->allocated)
+		return -EINVAL;
+
+	if (!slab->relocate)
+		return -ENOTSUP;
+
+	/* Move the last live element to the first free slot, until they cross */
+	for (limit = slab->ecount; limit;) {
+		ssize_t src, dst;
+		int err;
+
+		MUTEX_LOCK(slab->lock);
+		src = _slab_last_below(slab, limit);
+		bit_ffc(slab->allocated, slab->ecount, &dst);
+		if (src < 0 || dst < 0 || dst >= src) {
+			MUTEX_UNLOCK(slab->lock);
+			break;
+		}
+		bit_set(slab->allocated, dst);
+		MUTEX_UNLOCK(slab->lock);
+
+		/* The owner may use the pool from the callback */
+		err = slab->relocate(_slab_obj(slab, dst), _slab_obj(slab, src), slab->ctx);
+
+		MUTEX_LOCK(slab->lock);
+		if (!err) {
+			bit_clear(slab->allocated, src);
+			count++;
+		} else {
+			bit_clear(slab->allocated, dst);
+		}
+		MUTEX_UNLOCK(slab->lock);
+
+		limit = src;
+	}
+
+	MUTEX_LOCK(slab->lock);
+	bytes = _slab_release_free(slab, 0);
 	MUTEX_UNLOCK(slab->lock);
 
+	if (moved)
+		*moved = count;
+	if (released)
+		*released = bytes;
+
+	return 0;
+}
+
+ssize_t mm_slab_reclaim(struct mm_slab *slab, size_t limit)
+{
+	size_t bytes;
+
+	if (!slab)
+		return -EINVAL;
+
+	if (slab->magic != MM_SLAB_MAGIC)
+		return -EIO;
+
+	MUTEX_LOCK(slab->lock);
+	bytes = _slab_release_free(slab, limit);
+	MUTEX_UNLOCK(slab->lock);
+
+	return bytes;
+}
+
+ssize_t mm_slab_index(struct mm_slab *slab, const void *ptr)
+{
+	if (!slab || !ptr)
+		return -EINVAL;
+
+	if (slab->magic != MM_SLAB_MAGIC)
+		return -EIO;
+
+	return _slab_index(slab, ptr);
+}
+
+int mm_slab_inuse(struct mm_slab *slab, const void *ptr)
+{
+	ssize_t idx;
+
+	if (!slab || !ptr)
+		return -EINVAL;
+
+	if (slab->magic != MM_SLAB_MAGIC)
+		return -EIO;
+
+	idx = _slab_index(slab, ptr);
+	if (idx < 0)
+		return idx;
+
+	/* A pool without bitmap does not track its elements */
+	if (!slab->allocated)
+		return 1;
+
+	return !!(__atomic_load_n(&slab->allocated[_bit_idx(idx)], __ATOMIC_RELAXED) & _bit_mask(idx));
+}
+
+int mm_slab_range(struct mm_slab *slab, void **start, void **end)
+{
+	if (!slab)
+		return -EINVAL;
+
+	if (slab->magic != MM_SLAB_MAGIC)
+		return -EIO;
+
+	if (start)
+		*start = slab->pool;
+	if (end)
+		*end = (void *)((uintptr_t)slab->pool + slab->span);
+
+	return 0;
+}
+
+void *mm_slab_ptr(struct mm_slab *slab, size_t idx)
+{
+	if (!slab || slab->magic != MM_SLAB_MAGIC)
+		return NULL;
+
+	if (idx >= slab->ecount)
+		return NULL;
+
+	return _slab_obj(slab, idx);
+}
+
+int mm_slab_mem_stats(struct mm_slab *slab, size_t *prefaulted, size_t *faults, size_t *locked)
+{
+	if (!slab)
+		return -EINVAL;
+
+	if (slab->magic != MM_SLAB_MAGIC)
+		return -EIO;
+
+	if (prefaulted)
+		*prefaulted = slab->mem.prefaulted;
+	if (faults)
+		*faults = slab->mem.faults;
+	if (locked)
+		*locked = slab->mem.locked;
+
+	return 0;
+}
+
+int mm_slab_counters(struct mm_slab *slab, struct mm_slab_counters *counters)
+{
+	if (!slab || !counters)
+		return -EINVAL;
+
+	if (slab->magic != MM_SLAB_MAGIC)
+		return -EIO;
+
+	counters->allocated = _SLAB_STAT_READ(slab->stats.allocated);
+	counters->missed = _SLAB_STAT_READ(slab->stats.missed);
+	counters->freed = _SLAB_STAT_READ(slab->stats.freed);
+	counters->inuse = _SLAB_STAT_READ(slab->stats.inuse);
+	counters->hwm = _SLAB_STAT_READ(slab->stats.hwm);
+	counters->searched = _SLAB_STAT_READ(slab->stats.searched);
+
 	return 0;
 }
 
@@ -202,18 +1159,16 @@ int mm_slab_stats(struct mm_slab *slab,
 	if (slab->magic != MM_SLAB_MAGIC)
 		return -EIO;
 
-	MUTEX_LOCK(slab->lock);
 	if (esize)
 		*esize = slab->esize;
 	if (ecount)
 		*ecount = slab->ecount;
 	if (allocated)
-		*allocated = slab->stats.allocated;
+		*allocated = _SLAB_STAT_READ(slab->stats.allocated);
 	if (missed)
-		*missed = slab->stats.missed;
+		*missed = _SLAB_STAT_READ(slab->stats.missed);
 	if (freed)
-		*freed = slab->stats.freed;
-	MUTEX_UNLOCK(slab->lock);
+		*freed = _SLAB_STAT_READ(slab->stats.freed);
 
 	return 0;
 }
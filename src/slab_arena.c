@@ -7,174 +7,1327 @@
 
 #include <errno.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <mm/config/cdefs.h>
 #include <mm/config/config.h>
+#include <mm/config/mutex.h>
+#include <mm/config/thread.h>
 
 #include <mm/slab_arena.h>
 #include <mm/alloc.h>
+#include <mm/page.h>
 #include <mm/slab.h>
 
 /* --------------------------------------------------------------------------
  * INTERNAL TYPES
  * -------------------------------------------------------------------------- */
 
-struct _mm_slab_arena {
-	struct mm_slab **pool;
+/* Classes of sizes above MM_SLAB_ARENA_SMALL, per power of two */
+#define _ARENA_SUB_SHIFT 2
+#define _ARENA_SUB (1u << _ARENA_SUB_SHIFT)
+#define _ARENA_SMALL_CLASSES ((MM_SLAB_ARENA_SMALL >> 3) + 1)
+#define _ARENA_LARGE_CLASSES (64 * _ARENA_SUB)
+
+struct _arena_range {
+	uintptr_t start;
+	uintptr_t end;
+	struct mm_slab *pool;
+	size_t index;
+};
+
+/* Free elements cached by a thread, a stack per pool */
+struct _arena_bin {
+	unsigned int n;
+	void **obj;
+};
+
+struct _arena_tcache {
+	struct mm_slab_arena *arena;
+	struct _arena_tcache *next;
+	struct _arena_bin bin[];
+};
+
+/* Iteration of the elements of a class that are not held by a thread cache */
+struct _arena_visit {
+	void **cached; /* Sorted snapshot of the cached elements of the class */
+	size_t ncached;
+	size_t size; /* Room in @a cached */
+	mm_slab_foreach_t cb;
+	void *ctx;
+};
+
+/* Span of a class in the reservation, its pools are committed one after the other */
+struct _arena_span {
+	struct mm_page_provider provider;
+	uintptr_t start;
+	size_t size;
+	size_t used;
+};
+
+/* A size class, backed by up to MM_SLAB_ARENA_SLABS pools */
+struct _arena_class {
+	struct mm_slab *slab[MM_SLAB_ARENA_SLABS];
+	size_t nslabs;
+	size_t first; /* First range of the class in a reserved arena */
+	struct mm_slab_arena_config config;
+	struct _arena_span span;
+	size_t spilled;
+	size_t missed; /* Allocations the class could not serve */
+	size_t seen; /* missed at the previous mm_slab_arena_adapt_r() */
+	struct mm_slab_counters retired; /* Counters of the pools destroyed */
+};
+
+/*
+ * Size to pool lookup: the class tables give the first pool whose element size
+ * is at least the lowest size of a class, the element sizes (cached from the
+ * pools, sorted) then settle sizes of a class that span several pools.
+ *
+ * Pointer to pool lookup: the pool ranges sorted by address, pointers out of
+ * [min, max) (most heap fallbacks) are told apart with two compares. In a
+ * reserved arena, the class is the offset in the reservation shifted by the
+ * span order, its few ranges are then checked in turn.
+ */
+struct mm_slab_arena {
+	struct _arena_class *cls;
+	size_t *esize;
 	size_t count;
+	unsigned int spill;
+	struct _arena_range *range;
+	size_t nranges;
+	uintptr_t min;
+	uintptr_t max;
+	uint32_t small[_ARENA_SMALL_CLASSES];
+	uint32_t large[_ARENA_LARGE_CLASSES];
+
+	/* Pools added or retired so far, part of the stats generation */
+	size_t layout;
+
+	/* Reservation holding every pool, NULL if none */
+	void *base;
+	size_t reserved;
+	unsigned int shift;
+
+	/* Thread caches of up to tcache elements per pool, 0 if disabled */
+	unsigned int tcache;
+	THREAD_KEY_TYPE key;
+	MUTEX_TYPE lock;
+	struct _arena_tcache *tcaches;
 };
 
-/* --------------------------------------------------------------------------
- * LOCAL VARIABLES
- * -------------------------------------------------------------------------- */
+/* --------------------------------------------------------------------------
+ * LOCAL VARIABLES
+ * -------------------------------------------------------------------------- */
+
+/* Arena of the mm_slab_arena_*() functions without handle */
+static struct mm_slab_arena *_slab_arena;
+
+/* --------------------------------------------------------------------------
+ * LOCAL FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+static void _arena_release(struct mm_slab_arena *arena)
+{
+	if (arena->base)
+		(void)mm_page_unmap(arena->base, arena->reserved);
+	/* mm_free(NULL) is not a no-op with memory tracking */
+	if (arena->cls)
+		mm_free(arena->cls);
+	if (arena->esize)
+		mm_free(arena->esize);
+	if (arena->range)
+		mm_free(arena->range);
+	mm_free(arena);
+}
+
+/* Class of a size above MM_SLAB_ARENA_SMALL: power of two, then quarter */
+static inline size_t _arena_large_class(size_t size)
+{
+	unsigned int order = 63 - __builtin_clzll((unsigned long long)size - 1);
+
+	return order * _ARENA_SUB + (((size - 1) >> (order - _ARENA_SUB_SHIFT)) & (_ARENA_SUB - 1));
+}
+
+/* Lowest size of a class above MM_SLAB_ARENA_SMALL */
+static size_t _arena_large_lowest(size_t class)
+{
+	unsigned int order = class / _ARENA_SUB;
+	size_t sub = class % _ARENA_SUB;
+
+	return ((size_t)1 << order) + (sub << (order - _ARENA_SUB_SHIFT)) + 1;
+}
+
+static uint32_t _arena_first_pool(struct mm_slab_arena *arena, size_t size)
+{
+	uint32_t i;
+
+	for (i = 0; i < arena->count; i++)
+		if (arena->esize[i] >= size)
+			break;
+
+	return i;
+}
+
+static void _arena_build_classes(struct mm_slab_arena *arena)
+{
+	size_t c;
+
+	/* Bucket c holds the sizes (8c - 8, 8c], looked up from the lowest one */
+	for (c = 0; c < _ARENA_SMALL_CLASSES; c++)
+		arena->small[c] = _arena_first_pool(arena, c ? (c << 3) - 7 : 0);
+
+	for (c = 0; c < _ARENA_LARGE_CLASSES; c++) {
+		unsigned int order = c / _ARENA_SUB;
+
+		/* Classes below MM_SLAB_ARENA_SMALL are never used */
+		if ((order < _ARENA_SUB_SHIFT) || (((size_t)1 << order) < MM_SLAB_ARENA_SMALL))
+			arena->large[c] = 0;
+		else if (order >= 8 * sizeof(size_t))
+			arena->large[c] = arena->count;
+		else
+			arena->large[c] = _arena_first_pool(arena, _arena_large_lowest(c));
+	}
+}
+
+static int _arena_range_cmp(const void *a, const void *b)
+{
+	const struct _arena_range *ra = a, *rb = b;
+
+	return (ra->start > rb->start) - (ra->start < rb->start);
+}
+
+/* Lowest start and highest end of the ranges */
+static void _arena_range_bounds(struct mm_slab_arena *arena)
+{
+	size_t i;
+
+	arena->min = arena->nranges ? arena->range[0].start : 0;
+	arena->max = 0;
+	for (i = 0; i < arena->nranges; i++) {
+		if (arena->range[i].start < arena->min)
+			arena->min = arena->range[i].start;
+		if (arena->range[i].end > arena->max)
+			arena->max = arena->range[i].end;
+	}
+}
+
+/* A range table large enough for the pools and @a extra more */
+static struct _arena_range *_arena_alloc_ranges(struct mm_slab_arena *arena, size_t extra)
+{
+	size_t i, n = extra;
+
+	for (i = 0; i < arena->count; i++)
+		n += arena->cls[i].nslabs;
+
+	return mm_calloc(n ? n : 1, sizeof(struct _arena_range));
+}
+
+/* Fill @a range with the pools and swap it with the table in use */
+static void _arena_fill_ranges(struct mm_slab_arena *arena, struct _arena_range *range)
+{
+	size_t i, j, n = 0;
+
+	for (i = 0; i < arena->count; i++) {
+		arena->cls[i].first = n;
+		for (j = 0; j < arena->cls[i].nslabs; j++) {
+			struct _arena_range *r = &range[n];
+			struct mm_slab *slab = arena->cls[i].slab[j];
+			void *start, *end;
+
+			if (!slab || mm_slab_range(slab, &start, &end) < 0)
+				continue;
+
+			r->start = (uintptr_t)start;
+			r->end = (uintptr_t)end;
+			r->pool = slab;
+			r->index = i;
+			n++;
+		}
+	}
+
+	/* The ranges of a reserved arena are looked up per class instead */
+	if (!arena->base)
+		qsort(range, n, sizeof(struct _arena_range), _arena_range_cmp);
+
+	/* None yet on the first build */
+	if (arena->range)
+		mm_free(arena->range);
+	arena->range = range;
+	arena->nranges = n;
+	_arena_range_bounds(arena);
+}
+
+/* Build the range table of the pools, the previous one is kept on error */
+static int _arena_build_ranges(struct mm_slab_arena *arena)
+{
+	struct _arena_range *range = _arena_alloc_ranges(arena, 0);
+
+	if (!range)
+		return -ENOMEM;
+
+	_arena_fill_ranges(arena, range);
+
+	return 0;
+}
+
+/* Drop the ranges of destroyed pools from the table in place, keeping its order */
+static void _arena_prune_ranges(struct mm_slab_arena *arena)
+{
+	size_t i, k, n = 0, index = 0;
+
+	for (i = 0; i < arena->nranges; i++) {
+		struct _arena_range *r = &arena->range[i];
+		struct _arena_class *cls = &arena->cls[r->index];
+
+		for (k = 0; k < cls->nslabs; k++)
+			if (cls->slab[k] == r->pool)
+				break;
+
+		if (k < cls->nslabs)
+			arena->range[n++] = *r;
+	}
+	arena->nranges = n;
+
+	/* The first range of each class, for a reserved arena */
+	for (i = 0; i < arena->count; i++) {
+		while (index < n && arena->range[index].index < i)
+			index++;
+		arena->cls[i].first = index;
+	}
+
+	_arena_range_bounds(arena);
+}
+
+/* Range of the pool owning @a ptr, NULL for a heap fallback */
+static inline struct _arena_range *_arena_owner(struct mm_slab_arena *arena, const void *ptr)
+{
+	uintptr_t p = (uintptr_t)ptr;
+	size_t lo = 0, hi = arena->nranges;
+
+	if (p < arena->min || p >= arena->max)
+		return NULL;
+
+	if (arena->base) {
+		struct _arena_class *cls = &arena->cls[(p - (uintptr_t)arena->base) >> arena->shift];
+		size_t k, end = cls + 1 < arena->cls + arena->count ? (cls + 1)->first : arena->nranges;
+
+		for (k = cls->first; k < end; k++)
+			if (p >= arena->range[k].start && p < arena->range[k].end)
+				return &arena->range[k];
+
+		return NULL;
+	}
+
+	/* Last range starting at or before p */
+	while (hi - lo > 1) {
+		size_t mid = (lo + hi) / 2;
+
+		if (arena->range[mid].start <= p)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	if (p < arena->range[lo].end)
+		return &arena->range[lo];
+
+	return NULL;
+}
+
+/* Index of the first class able to hold @a size, count if none */
+static inline size_t _arena_pool(struct mm_slab_arena *arena, size_t size)
+{
+	size_t i;
+
+	if (size <= MM_SLAB_ARENA_SMALL)
+		i = arena->small[(size + 7) >> 3];
+	else
+		i = arena->large[_arena_large_class(size)];
+
+	while (i < arena->count && size > arena->esize[i])
+		i++;
+
+	return i;
+}
+
+/* Commit the next part of a class span for a new pool */
+static void *_span_map(void *ctx, size_t *size, unsigned int flags)
+{
+	struct _arena_span *span = ctx;
+	size_t len = ROUNDUP(*size, mm_page_size());
+	void *addr = (void *)(span->start + span->used);
+
+	(void)flags;
+
+	if (len > span->size - span->used || mm_page_commit(addr, len) < 0)
+		return NULL;
+
+	span->used += len;
+	*size = len;
+
+	return addr;
+}
+
+/* Decommit a retired pool, the span shrinks back if it was the last one */
+static void _span_unmap(void *ctx, void *addr, size_t size)
+{
+	struct _arena_span *span = ctx;
+
+	(void)mm_page_decommit(addr, size);
+	if ((uintptr_t)addr + size == span->start + span->used)
+		span->used -= size;
+}
+
+static int _span_release(void *ctx, void *addr, size_t size)
+{
+	(void)ctx;
+
+	return mm_page_release(addr, size);
+}
+
+static struct mm_slab *_arena_slab_create(struct _arena_class *cls, size_t ecount)
+{
+	struct mm_slab_config sconfig = {
+		.alignment = MM_ALIGN,
+		.esize = cls->config.esize,
+		.ecount = ecount,
+		.flags = cls->config.flags,
+		.numa = cls->config.numa,
+	};
+
+	if (cls->span.size) {
+		sconfig.flags |= MM_SLAB_F_PAGES;
+		sconfig.provider = &cls->span.provider;
+	}
+
+	return mm_slab_create_config(&sconfig);
+}
+
+/* Allocate from the pools of a class, in the order they were added */
+static inline void *_class_alloc(struct _arena_class *cls)
+{
+	size_t j;
+
+	for (j = 0; j < cls->nslabs; j++) {
+		void *ptr = mm_slab_alloc(cls->slab[j]);
+
+		if (ptr)
+			return ptr;
+	}
+
+	return NULL;
+}
+
+/* Number of elements and number of elements in use of a class */
+static void _class_usage(struct _arena_class *cls, size_t *ecount, size_t *inuse)
+{
+	size_t j;
+
+	*ecount = 0;
+	*inuse = 0;
+
+	for (j = 0; j < cls->nslabs; j++) {
+		struct mm_slab_counters c;
+		size_t n;
+
+		if (mm_slab_stats(cls->slab[j], NULL, &n, NULL, NULL, NULL) < 0 ||
+		    mm_slab_counters(cls->slab[j], &c) < 0)
+			continue;
+
+		*ecount += n;
+		*inuse += c.inuse;
+	}
+}
+
+/* Stats of class @a i, from the lock-free counters of its pools added up */
+static int _class_stats(struct mm_slab_arena *arena, size_t i, struct mm_slab_arena_stats *s)
+{
+	struct _arena_class *cls = &arena->cls[i];
+	size_t j;
+
+	memset(s, 0, sizeof(*s));
+	s->esize = arena->esize[i];
+	s->spilled = __atomic_load_n(&cls->spilled, __ATOMIC_RELAXED);
+	s->allocated = __atomic_load_n(&cls->retired.allocated, __ATOMIC_RELAXED);
+	s->missed = __atomic_load_n(&cls->retired.missed, __ATOMIC_RELAXED);
+	s->freed = __atomic_load_n(&cls->retired.freed, __ATOMIC_RELAXED);
+	s->hwm = __atomic_load_n(&cls->retired.hwm, __ATOMIC_RELAXED);
+
+	for (j = 0; j < cls->nslabs; j++) {
+		struct mm_slab_counters c;
+		size_t ecount, faults, locked;
+		int err;
+
+		err = mm_slab_stats(cls->slab[j], NULL, &ecount, NULL, NULL, NULL);
+		if (!err)
+			err = mm_slab_mem_stats(cls->slab[j], NULL, &faults, &locked);
+		if (!err)
+			err = mm_slab_counters(cls->slab[j], &c);
+		if (err < 0)
+			return err;
+
+		s->ecount += ecount;
+		s->allocated += c.allocated;
+		s->missed += c.missed;
+		s->freed += c.freed;
+		s->inuse += c.inuse;
+		s->hwm += c.hwm;
+		s->faults += faults;
+		s->locked += locked;
+	}
+
+	return 0;
+}
+
+/* Destroy pool @a j of a class, its counters kept for the stats of the class */
+static int _class_retire(struct _arena_class *cls, size_t j)
+{
+	struct mm_slab_counters c;
+	int err;
+
+	err = mm_slab_counters(cls->slab[j], &c);
+	if (err < 0)
+		return err;
+
+	err = mm_slab_destroy(cls->slab[j]);
+	if (err < 0)
+		return err;
+
+	__atomic_fetch_add(&cls->retired.allocated, c.allocated, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&cls->retired.missed, c.missed, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&cls->retired.freed, c.freed, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&cls->retired.hwm, c.hwm, __ATOMIC_RELAXED);
+	cls->slab[j] = NULL;
+
+	return 0;
+}
+
+/* Drop the pools of a class that were destroyed, keeping their order */
+static void _class_compact(struct _arena_class *cls)
+{
+	size_t j, n = 0;
+
+	for (j = 0; j < cls->nslabs; j++)
+		if (cls->slab[j])
+			cls->slab[n++] = cls->slab[j];
+
+	for (j = n; j < cls->nslabs; j++)
+		cls->slab[j] = NULL;
+
+	cls->nslabs = n;
+}
+
+/* Give @a n elements of a thread cache of class @a i back to their pools */
+static void _tcache_flush_bin(struct mm_slab_arena *arena, size_t i, struct _arena_bin *bin, unsigned int n)
+{
+	struct _arena_class *cls = &arena->cls[i];
+	unsigned int k;
+
+	/*
+	 * A class backed by several pools, or one bad pointer failing the whole
+	 * batch, release the elements one by one
+	 */
+	if (cls->nslabs != 1 || mm_slab_free_bulk(cls->slab[0], bin->obj, n) < 0) {
+		for (k = 0; k < n; k++) {
+			struct _arena_range *r = _arena_owner(arena, bin->obj[k]);
+
+			if (r)
+				(void)mm_slab_free(r->pool, bin->obj[k]);
+		}
+	}
+
+	bin->n -= n;
+	memmove(bin->obj, bin->obj + n, bin->n * sizeof(void *));
+}
+
+static void _tcache_flush(struct _arena_tcache *tc)
+{
+	struct mm_slab_arena *arena = tc->arena;
+	size_t i;
+
+	for (i = 0; i < arena->count; i++)
+		if (tc->bin[i].n)
+			_tcache_flush_bin(arena, i, &tc->bin[i], tc->bin[i].n);
+}
+
+/* Thread exit: the cached elements go back to the pools */
+static void _tcache_exit(void *data)
+{
+	struct _arena_tcache *tc = data, **prev;
+	struct mm_slab_arena *arena = tc->arena;
+
+	MUTEX_LOCK(arena->lock);
+	_tcache_flush(tc);
+	for (prev = &arena->tcaches; *prev; prev = &(*prev)->next) {
+		if (*prev == tc) {
+			*prev = tc->next;
+			break;
+		}
+	}
+	MUTEX_UNLOCK(arena->lock);
+
+	mm_free(tc);
+}
+
+/* Cache of the calling thread, created on first use */
+static struct _arena_tcache *_tcache_get(struct mm_slab_arena *arena)
+{
+	struct _arena_tcache *tc;
+	void **obj;
+	size_t i;
+
+	tc = THREAD_GETSPECIFIC(arena->key);
+	if (tc)
+		return tc;
+
+	tc = mm_calloc(1, sizeof(struct _arena_tcache) +
+			  arena->count * (sizeof(struct _arena_bin) + arena->tcache * sizeof(void *)));
+	if (!tc)
+		return NULL;
+
+	tc->arena = arena;
+	obj = (void **)&tc->bin[arena->count];
+	for (i = 0; i < arena->count; i++)
+		tc->bin[i].obj = obj + i * arena->tcache;
+
+	if (THREAD_SETSPECIFIC(arena->key, tc) != 0) {
+		mm_free(tc);
+		return NULL;
+	}
+
+	MUTEX_LOCK(arena->lock);
+	tc->next = arena->tcaches;
+	arena->tcaches = tc;
+	MUTEX_UNLOCK(arena->lock);
+
+	return tc;
+}
+
+/* Pop an element of pool @a i, refilled by half a cache at once when empty */
+static inline void *_tcache_alloc(struct mm_slab_arena *arena, size_t i)
+{
+	struct _arena_tcache *tc;
+	struct _arena_bin *bin;
+
+	tc = _tcache_get(arena);
+	if (!tc)
+		return NULL;
+
+	bin = &tc->bin[i];
+	if (!bin->n) {
+		struct _arena_class *cls = &arena->cls[i];
+		size_t j;
+
+		for (j = 0; j < cls->nslabs && !bin->n; j++) {
+			int n = mm_slab_alloc_bulk(cls->slab[j], bin->obj, (arena->tcache + 1) / 2);
+
+			if (n > 0)
+				bin->n = n;
+		}
+
+		if (!bin->n)
+			return NULL;
+	}
+
+	return bin->obj[--bin->n];
+}
+
+/* Push an element of pool @a i, the oldest half goes back to it when full */
+static inline bool _tcache_free(struct mm_slab_arena *arena, size_t i, void *ptr)
+{
+	struct _arena_tcache *tc;
+	struct _arena_bin *bin;
+
+	tc = _tcache_get(arena);
+	if (!tc)
+		return false;
+
+	bin = &tc->bin[i];
+#if defined(DEBUG)
+	{
+		unsigned int k;
+
+		/* Already cached by this thread, a double free is not cached twice */
+		for (k = 0; k < bin->n; k++)
+			if (bin->obj[k] == ptr)
+				return true;
+	}
+#endif /* DEBUG */
+
+	if (bin->n == arena->tcache)
+		_tcache_flush_bin(arena, i, bin, (arena->tcache + 1) / 2);
+
+	bin->obj[bin->n++] = ptr;
+
+	return true;
+}
+
+/* Reserve a span of 2^shift bytes per class, huge-page aligned when possible */
+static int _arena_reserve(struct mm_slab_arena *arena, size_t span)
+{
+	unsigned int shift = 0, flags = 0;
+	size_t i, align;
+
+	while (((size_t)1 << shift) < span || ((size_t)1 << shift) < mm_page_size()) {
+		if (shift == 8 * sizeof(size_t) - 1)
+			return -EINVAL;
+		shift++;
+	}
+
+	if (arena->count > (SIZE_MAX >> shift))
+		return -EINVAL;
+
+	for (i = 0; i < arena->count; i++)
+		if (arena->cls[i].config.flags & MM_SLAB_F_HUGEPAGE)
+			flags |= MM_PAGE_F_HUGE;
+
+	align = (size_t)1 << shift;
+	if (align > MM_HUGEPAGE_SIZE)
+		align = MM_HUGEPAGE_SIZE;
+
+	arena->reserved = arena->count << shift;
+	arena->base = mm_page_reserve(&arena->reserved, align, flags);
+	if (!arena->base)
+		return -ENOMEM;
+
+	arena->shift = shift;
+	for (i = 0; i < arena->count; i++) {
+		struct _arena_span *s = &arena->cls[i].span;
+
+		s->provider.map = _span_map;
+		s->provider.unmap = _span_unmap;
+		s->provider.release = _span_release;
+		s->provider.ctx = s;
+		s->start = (uintptr_t)arena->base + (i << shift);
+		s->size = (size_t)1 << shift;
+	}
+
+	return 0;
+}
+
+static int _arena_create(struct mm_slab_arena **arenap, struct mm_slab_arena_config *config, size_t count,
+			 size_t span)
+{
+	struct mm_slab_arena *arena;
+	int i, err;
+
+	if (!arenap || !config || !count)
+		return -EINVAL;
+
+	for (i = 1; i < count; i++)
+		if (config[i].esize < config[i - 1].esize)
+			return -EINVAL;
+
+	arena = mm_calloc(1, sizeof(struct mm_slab_arena));
+	if (!arena)
+		return -ENOMEM;
+
+	arena->count = count;
+	arena->cls = mm_calloc(count, sizeof(struct _arena_class));
+	arena->esize = mm_calloc(count, sizeof(size_t));
+	if (!arena->cls || !arena->esize) {
+		_arena_release(arena);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < count; i++)
+		arena->cls[i].config = config[i];
+
+	if (span) {
+		err = _arena_reserve(arena, span);
+		if (err < 0) {
+			_arena_release(arena);
+			return err;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		struct _arena_class *cls = &arena->cls[i];
+
+		cls->slab[0] = _arena_slab_create(cls, config[i].ecount);
+		if (cls->slab[0]) {
+			cls->nslabs = 1;
+			(void)mm_slab_stats(cls->slab[0], &arena->esize[i], NULL, NULL, NULL, NULL);
+		} else {
+			arena->esize[i] = i ? arena->esize[i - 1] : 0;
+		}
+	}
+
+	_arena_build_classes(arena);
+
+	err = _arena_build_ranges(arena);
+	if (err < 0) {
+		for (i = 0; i < count; i++)
+			if (arena->cls[i].slab[0])
+				(void)mm_slab_destroy(arena->cls[i].slab[0]);
+		_arena_release(arena);
+		return err;
+	}
+
+	*arenap = arena;
+
+	return 0;
+}
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+int mm_slab_arena_create_r(struct mm_slab_arena **arenap, struct mm_slab_arena_config *config, size_t count)
+{
+	return _arena_create(arenap, config, count, 0);
+}
+
+int mm_slab_arena_create_reserved_r(struct mm_slab_arena **arenap, struct mm_slab_arena_config *config,
+				    size_t count, size_t span)
+{
+	if (!span)
+		return -EINVAL;
+
+	return _arena_create(arenap, config, count, span);
+}
+
+int mm_slab_arena_destroy_r(struct mm_slab_arena *arena)
+{
+	int i;
+	bool destroyed = true;
+
+	if (!arena)
+		return -EINVAL;
+
+	if (arena->tcache) {
+		struct _arena_tcache *tc;
+
+		MUTEX_LOCK(arena->lock);
+		for (tc = arena->tcaches; tc; tc = tc->next)
+			_tcache_flush(tc);
+		MUTEX_UNLOCK(arena->lock);
+	}
+
+	for (i = 0; i < arena->count; i++) {
+		struct _arena_class *cls = &arena->cls[i];
+		size_t j;
+
+		for (j = 0; j < cls->nslabs; j++) {
+			if (_class_retire(cls, j) < 0)
+				destroyed = false;
+		}
+
+		_class_compact(cls);
+	}
+
+	if (destroyed) {
+		if (arena->tcache) {
+			/* Deleting the key does not call the destructors */
+			(void)THREAD_KEY_DELETE(arena->key);
+			while (arena->tcaches) {
+				struct _arena_tcache *tc = arena->tcaches;
+
+				arena->tcaches = tc->next;
+				mm_free(tc);
+			}
+			MUTEX_DESTROY(arena->lock);
+		}
+
+		_arena_release(arena);
+		return 0;
+	}
+
+	/* Buffers of the remaining pools are still freed to them */
+	if (_arena_build_ranges(arena) < 0)
+		_arena_prune_ranges(arena);
+
+	return -EAGAIN;
+}
+
+__attribute__((__malloc__(mm_slab_arena_free_r, 2)))
+void *mm_slab_arena_malloc_r(struct mm_slab_arena *arena, size_t size)
+{
+	size_t i, fit, classes = 0;
+	void *ptr = NULL;
+
+	if (!arena || !size)
+		return NULL;
+
+	fit = _arena_pool(arena, size);
+	if (arena->tcache && fit < arena->count && arena->cls[fit].nslabs) {
+		ptr = _tcache_alloc(arena, fit);
+		if (ptr)
+			return ptr;
+	}
+
+	/* Pools that failed to be created are skipped */
+	for (i = fit; i < arena->count; i++) {
+		if (!arena->cls[i].nslabs)
+			continue;
+
+		/* Exhausted classes hand over to up to spill larger ones */
+		if (classes++ > arena->spill)
+			break;
+
+		ptr = _class_alloc(&arena->cls[i]);
+		if (!ptr) {
+			if (i == fit)
+				__atomic_fetch_add(&arena->cls[fit].missed, 1, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		if (classes > 1)
+			__atomic_fetch_add(&arena->cls[fit].spilled, 1, __ATOMIC_RELAXED);
 
-static struct _mm_slab_arena _slab_arena = { 0 };
+		return ptr;
+	}
 
-/* --------------------------------------------------------------------------
- * PUBLIC FUNCTIONS
- * -------------------------------------------------------------------------- */
+	ptr = mm_malloc(size);
+	return ptr;
+}
 
-int mm_slab_arena_create(struct mm_slab_arena_config *config, size_t count)
+int mm_slab_arena_spill_r(struct mm_slab_arena *arena, unsigned int classes)
 {
-	int i;
+	if (!arena)
+		return -EINVAL;
+
+	arena->spill = classes;
+
+	return 0;
+}
+
+__attribute__((__malloc__(mm_slab_arena_free_r, 2)))
+void *mm_slab_arena_calloc_r(struct mm_slab_arena *arena, size_t nmemb, size_t size)
+{
+	void *ptr;
+
+	if (!nmemb || !size)
+		return NULL;
+
+	ptr = mm_slab_arena_malloc_r(arena, nmemb * size);
+	if (ptr)
+		memset(ptr, 0x0, nmemb * size);
+
+	return ptr;
+}
 
-	if (!config || !count)
+void *mm_slab_arena_realloc_r(struct mm_slab_arena *arena, void *ptr, size_t size)
+{
+	struct _arena_range *r;
+	void *new;
+
+	if (!arena)
+		return NULL;
+
+	if (!ptr)
+		return mm_slab_arena_malloc_r(arena, size);
+
+	if (!size) {
+		(void)mm_slab_arena_free_r(arena, ptr);
+		return NULL;
+	}
+
+	/* The heap keeps its own buffers and knows their size */
+	r = _arena_owner(arena, ptr);
+	if (!r)
+		return mm_realloc(ptr, size);
+
+	/* Same check as mm_slab_free(), before the element is used */
+	if (mm_slab_index(r->pool, ptr) < 0)
+		return NULL;
+
+	/* Still fits: moved down to the smallest class with room, else kept in place */
+	if (size <= arena->esize[r->index]) {
+		size_t i;
+
+		for (i = _arena_pool(arena, size); i < r->index; i++) {
+			if (arena->esize[i] >= arena->esize[r->index] || !arena->cls[i].nslabs)
+				continue;
+
+			new = _class_alloc(&arena->cls[i]);
+			if (new) {
+				memcpy(new, ptr, size);
+				(void)mm_slab_arena_free_r(arena, ptr);
+				return new;
+			}
+		}
+
+		return ptr;
+	}
+
+	new = mm_slab_arena_malloc_r(arena, size);
+	if (!new)
+		return NULL;
+
+	memcpy(new, ptr, arena->esize[r->index]);
+	(void)mm_slab_arena_free_r(arena, ptr);
+
+	return new;
+}
+
+int mm_slab_arena_free_r(struct mm_slab_arena *arena, void *ptr)
+{
+	struct _arena_range *r;
+
+	if (!arena || !ptr)
 		return -EINVAL;
 
-	_slab_arena.count = count;
-	_slab_arena.pool = mm_calloc(count, sizeof(struct sys_slab *));
-	if (!_slab_arena.pool)
-		return -ENOMEM;
+	r = _arena_owner(arena, ptr);
+	if (!r) {
+		mm_free(ptr);
+		return 0;
+	}
 
-	for (i = 0; i < count; i++) {
-		if (i && (config[i].esize < config[i - 1].esize))
-			return i - 1;
+#if defined(DEBUG)
+	/* Elements free in their pool are not cached, the pool ignores the double free */
+	if (arena->tcache && mm_slab_inuse(r->pool, ptr) > 0 && _tcache_free(arena, r->index, ptr))
+		return 0;
+#else
+	/* Only the element boundaries are checked before caching */
+	if (arena->tcache && mm_slab_index(r->pool, ptr) >= 0 && _tcache_free(arena, r->index, ptr))
+		return 0;
+#endif /* DEBUG */
+
+	return mm_slab_free(r->pool, ptr);
+}
+
+int mm_slab_arena_tcache_r(struct mm_slab_arena *arena, unsigned int count)
+{
+	int err;
+
+	if (!arena || !count)
+		return -EINVAL;
+
+	if (arena->tcache)
+		return -EBUSY;
 
-		_slab_arena.pool[i] = mm_slab_create(NULL, MM_ALIGN, config[i].esize, config[i].ecount);
+	err = MUTEX_INIT(arena->lock);
+	if (err)
+		return err < 0 ? err : -err;
+
+	err = THREAD_KEY_CREATE(&arena->key, _tcache_exit);
+	if (err) {
+		MUTEX_DESTROY(arena->lock);
+		return err < 0 ? err : -err;
 	}
 
+	arena->tcache = count;
+
 	return 0;
 }
 
-int mm_slab_arena_destroy(void)
+int mm_slab_arena_tcache_flush_r(struct mm_slab_arena *arena)
 {
-	int i;
-	bool destroyed = true;
+	struct _arena_tcache *tc;
 
-	for (i = 0; i < _slab_arena.count; i++) {
-		int err;
+	if (!arena)
+		return -EINVAL;
 
-		if (!_slab_arena.pool[i])
-			continue;
+	if (!arena->tcache)
+		return 0;
 
-		err = mm_slab_destroy(_slab_arena.pool[i]);
-		if (err < 0)
-			continue;
+	tc = THREAD_GETSPECIFIC(arena->key);
+	if (tc)
+		_tcache_flush(tc);
+
+	return 0;
+}
+
+static int _arena_ptr_cmp(const void *a, const void *b)
+{
+	uintptr_t pa = (uintptr_t)*(void *const *)a, pb = (uintptr_t)*(void *const *)b;
+
+	return (pa > pb) - (pa < pb);
+}
 
-		destroyed = destroyed && (err == 0);
-		_slab_arena.pool[i] = NULL;
+/*
+ * Copy the elements of class @a i held by the thread caches, sorted. The list
+ * of caches is locked, the bins of the other threads are read as they are: an
+ * element cached or taken during the iteration may or may not be visited.
+ */
+static int _arena_snapshot_cached(struct mm_slab_arena *arena, size_t i, struct _arena_visit *v)
+{
+	struct _arena_tcache *tc;
+	size_t max = 0;
+
+	v->ncached = 0;
+
+	MUTEX_LOCK(arena->lock);
+	for (tc = arena->tcaches; tc; tc = tc->next)
+		max += arena->tcache;
+
+	/* Threads may have started since the previous class */
+	if (max > v->size) {
+		void **cached = mm_realloc(v->cached, max * sizeof(void *));
+
+		if (!cached) {
+			MUTEX_UNLOCK(arena->lock);
+			return -ENOMEM;
+		}
+		v->cached = cached;
+		v->size = max;
 	}
 
-	if (destroyed) {
-		mm_free(_slab_arena.pool);
-		_slab_arena.pool = NULL;
-		_slab_arena.count = 0;
+	for (tc = arena->tcaches; tc; tc = tc->next) {
+		struct _arena_bin *bin = &tc->bin[i];
+		unsigned int k, n = __atomic_load_n(&bin->n, __ATOMIC_RELAXED);
+
+		for (k = 0; k < n && k < arena->tcache; k++)
+			v->cached[v->ncached++] = __atomic_load_n(&bin->obj[k], __ATOMIC_RELAXED);
+	}
+	MUTEX_UNLOCK(arena->lock);
+
+	qsort(v->cached, v->ncached, sizeof(void *), _arena_ptr_cmp);
+
+	return 0;
+}
+
+/* Skip the elements held by a thread cache, allocated in their pool but free */
+static int _arena_visit(void *obj, void *ctx)
+{
+	struct _arena_visit *v = ctx;
+
+	if (v->ncached && bsearch(&obj, v->cached, v->ncached, sizeof(void *), _arena_ptr_cmp))
 		return 0;
+
+	return v->cb(obj, v->ctx);
+}
+
+int mm_slab_arena_foreach_r(struct mm_slab_arena *arena, mm_slab_foreach_t cb, void *ctx)
+{
+	struct _arena_visit v = { NULL, 0, 0, cb, ctx };
+	int i, ret = 0;
+
+	if (!arena || !cb)
+		return -EINVAL;
+
+	for (i = 0; i < arena->count && !ret; i++) {
+		size_t j;
+
+		if (arena->tcache) {
+			ret = _arena_snapshot_cached(arena, i, &v);
+			if (ret < 0)
+				break;
+		}
+
+		for (j = 0; j < arena->cls[i].nslabs && !ret; j++)
+			ret = v.ncached ? mm_slab_foreach(arena->cls[i].slab[j], _arena_visit, &v) :
+					  mm_slab_foreach(arena->cls[i].slab[j], cb, ctx);
 	}
 
-	return -EAGAIN;
+	if (v.cached)
+		mm_free(v.cached);
+
+	return ret;
 }
 
-__attribute__((__malloc__(mm_slab_arena_free, 1)))
-void *mm_slab_arena_malloc(size_t size)
+ssize_t mm_slab_arena_reclaim_r(struct mm_slab_arena *arena, size_t limit)
 {
-	int i, err;
-	void *ptr = NULL;
+	size_t bytes = 0;
+	int i;
 
-	if (!_slab_arena.pool || !size)
-		return NULL;
+	if (!arena)
+		return -EINVAL;
+
+	for (i = 0; i < arena->count && (!limit || bytes < limit); i++) {
+		size_t j;
+
+		for (j = 0; j < arena->cls[i].nslabs && (!limit || bytes < limit); j++) {
+			ssize_t ret = mm_slab_reclaim(arena->cls[i].slab[j], limit ? limit - bytes : 0);
+
+			if (ret > 0)
+				bytes += ret;
+		}
+	}
 
-	for (i = 0; i < _slab_arena.count; i++) {
-		size_t esize;
+	return bytes;
+}
+
+ssize_t mm_slab_arena_adapt_r(struct mm_slab_arena *arena, size_t budget)
+{
+	struct _arena_range *range;
+	size_t i, footprint = 0, changes = 0, grown = 0;
+
+	if (!arena || !budget)
+		return -EINVAL;
+
+	/* Room for one new pool per class, the table is ready before any change */
+	range = _arena_alloc_ranges(arena, arena->count);
+	if (!range)
+		return -ENOMEM;
+
+	for (i = 0; i < arena->count; i++) {
+		size_t ecount, inuse;
 
-		if (!_slab_arena.pool[i])
+		_class_usage(&arena->cls[i], &ecount, &inuse);
+		footprint += ecount * arena->esize[i];
+	}
+
+	/* Cold classes give their last pool back once it is empty */
+	for (i = 0; i < arena->count; i++) {
+		struct _arena_class *cls = &arena->cls[i];
+		struct mm_slab *last;
+		size_t ecount, inuse, lcount;
+
+		if (cls->nslabs < 2 || __atomic_load_n(&cls->missed, __ATOMIC_RELAXED) != cls->seen)
 			continue;
 
-		err = mm_slab_stats(_slab_arena.pool[i], &esize, NULL, NULL, NULL, NULL);
-		if (err < 0)
+		last = cls->slab[cls->nslabs - 1];
+		_class_usage(cls, &ecount, &inuse);
+		if (mm_slab_stats(last, NULL, &lcount, NULL, NULL, NULL) < 0)
 			continue;
 
-		if (size > esize)
+		/* Keep half of the remaining pools free to avoid growing right back */
+		if (inuse > (ecount - lcount) / 2 || _class_retire(cls, cls->nslabs - 1) < 0)
 			continue;
 
-		ptr = mm_slab_alloc(_slab_arena.pool[i]);
-		if (!ptr)
+		cls->nslabs--;
+		footprint -= lcount * arena->esize[i];
+		changes++;
+	}
+
+	/* Hot classes double, the most missed first, as long as the budget allows */
+	for (;;) {
+		struct _arena_class *cls = NULL;
+		struct mm_slab *slab;
+		size_t hot = 0, ecount, inuse;
+
+		for (i = 0; i < arena->count; i++) {
+			size_t missed = __atomic_load_n(&arena->cls[i].missed, __ATOMIC_RELAXED);
+
+			if (arena->cls[i].nslabs && missed - arena->cls[i].seen > hot) {
+				hot = missed - arena->cls[i].seen;
+				cls = &arena->cls[i];
+			}
+		}
+
+		if (!cls || grown == arena->count)
 			break;
 
-		return ptr;
+		i = cls - arena->cls;
+		cls->seen += hot;
+		if (cls->nslabs == MM_SLAB_ARENA_SLABS || footprint >= budget)
+			continue;
+
+		_class_usage(cls, &ecount, &inuse);
+		if (ecount > (budget - footprint) / arena->esize[i])
+			ecount = (budget - footprint) / arena->esize[i];
+		if (!ecount)
+			continue;
+
+		slab = _arena_slab_create(cls, ecount);
+		if (!slab)
+			continue;
+
+		cls->slab[cls->nslabs++] = slab;
+		footprint += ecount * arena->esize[i];
+		changes++;
+		grown++;
 	}
 
-	ptr = mm_malloc(size);
-	return ptr;
+	if (!changes) {
+		mm_free(range);
+		return 0;
+	}
+
+	__atomic_fetch_add(&arena->layout, changes, __ATOMIC_RELAXED);
+	_arena_fill_ranges(arena, range);
+
+	return changes;
 }
 
-__attribute__((__malloc__(mm_slab_arena_free, 1)))
-void *mm_slab_arena_calloc(size_t nmemb, size_t size)
+int mm_slab_arena_get_config_r(struct mm_slab_arena *arena, struct mm_slab_arena_config **config, size_t *count)
 {
-	void *ptr;
+	struct mm_slab_arena_config *c;
+	size_t i;
 
-	if (!nmemb || !size)
-		return NULL;
+	if (!arena || !config || !count)
+		return -EINVAL;
 
-	ptr = mm_slab_arena_malloc(nmemb * size);
-	if (ptr)
-		memset(ptr, 0x0, nmemb * size);
+	c = mm_calloc(arena->count, sizeof(struct mm_slab_arena_config));
+	if (!c)
+		return -ENOMEM;
 
-	return ptr;
+	for (i = 0; i < arena->count; i++) {
+		size_t ecount, inuse;
+
+		c[i] = arena->cls[i].config;
+		_class_usage(&arena->cls[i], &ecount, &inuse);
+		if (ecount)
+			c[i].ecount = ecount;
+	}
+
+	*config = c;
+	*count = arena->count;
+
+	return *count;
 }
 
-int mm_slab_arena_free(void *ptr)
+int mm_slab_arena_snapshot_r(struct mm_slab_arena *arena, struct mm_slab_arena_stats *stats, size_t count,
+			     uint64_t *generation)
 {
-	int i;
+	uint64_t gen;
+	size_t i;
 
-	if (!_slab_arena.pool || !ptr)
+	if (!arena || (count && !stats))
 		return -EINVAL;
 
-	for (i = 0; i < _slab_arena.count; i++) {
-		int err;
+	gen = __atomic_load_n(&arena->layout, __ATOMIC_RELAXED);
+	for (i = 0; i < arena->count; i++) {
+		struct mm_slab_arena_stats s;
 
-		if (!_slab_arena.pool[i])
-			continue;
+		(void)_class_stats(arena, i, &s);
+		gen += s.allocated + s.missed + s.freed + s.spilled;
+		if (i < count)
+			stats[i] = s;
+	}
 
-		err = mm_slab_free(_slab_arena.pool[i], ptr) ;
-		if (err < 0)
-			continue;
+	if (generation)
+		*generation = gen;
+
+	return arena->count;
+}
+
+uint64_t mm_slab_arena_generation_r(struct mm_slab_arena *arena)
+{
+	uint64_t gen;
+	size_t i, j;
 
+	if (!arena)
 		return 0;
-	}
 
-	mm_free(ptr);
+	gen = __atomic_load_n(&arena->layout, __ATOMIC_RELAXED);
+	for (i = 0; i < arena->count; i++) {
+		struct _arena_class *cls = &arena->cls[i];
 
-	return 0;
+		gen += __atomic_load_n(&cls->spilled, __ATOMIC_RELAXED);
+		gen += __atomic_load_n(&cls->retired.allocated, __ATOMIC_RELAXED);
+		gen += __atomic_load_n(&cls->retired.missed, __ATOMIC_RELAXED);
+		gen += __atomic_load_n(&cls->retired.freed, __ATOMIC_RELAXED);
+		for (j = 0; j < cls->nslabs; j++) {
+			struct mm_slab_counters c;
+
+			if (mm_slab_counters(cls->slab[j], &c) == 0)
+				gen += c.allocated + c.missed + c.freed;
+		}
+	}
+
+	return gen;
 }
 
-int mm_slab_arena_stats(struct mm_slab_arena_stats **stats, size_t *count)
+int mm_slab_arena_stats_r(struct mm_slab_arena *arena, struct mm_slab_arena_stats **stats, size_t *count)
 {
 	struct mm_slab_arena_stats *s;
 	int i;
 
-	if (!_slab_arena.pool || !stats || !count)
+	if (!arena || !stats || !count)
 		return -EINVAL;
 
-	s = mm_calloc(_slab_arena.count, sizeof(struct mm_slab_arena_stats));
+	s = mm_calloc(arena->count, sizeof(struct mm_slab_arena_stats));
 	if (!s)
 		return -ENOMEM;
 
-	for (i = 0; i < _slab_arena.count; i++) {
-		int err;
+	for (i = 0; i < arena->count; i++) {
+		int err = arena->cls[i].nslabs ? _class_stats(arena, i, &s[i]) : -EINVAL;
 
-		err = mm_slab_stats(_slab_arena.pool[i], &s[i].esize, &s[i].ecount, &s[i].allocated, &s[i].missed, &s[i].freed);
 		if (err < 0) {
 			*count = 0;
 			*stats = NULL;
@@ -183,7 +1336,106 @@ int mm_slab_arena_stats(struct mm_slab_arena_stats **stats, size_t *count)
 		}
 	}
 
-	*count = _slab_arena.count;
+	*count = arena->count;
 	*stats = s;
 	return *count;
 }
+
+int mm_slab_arena_snapshot(struct mm_slab_arena_stats *stats, size_t count, uint64_t *generation)
+{
+	return mm_slab_arena_snapshot_r(_slab_arena, stats, count, generation);
+}
+
+uint64_t mm_slab_arena_generation(void)
+{
+	return mm_slab_arena_generation_r(_slab_arena);
+}
+
+int mm_slab_arena_create(struct mm_slab_arena_config *config, size_t count)
+{
+	if (_slab_arena)
+		return -EBUSY;
+
+	return mm_slab_arena_create_r(&_slab_arena, config, count);
+}
+
+int mm_slab_arena_create_reserved(struct mm_slab_arena_config *config, size_t count, size_t span)
+{
+	if (_slab_arena)
+		return -EBUSY;
+
+	return mm_slab_arena_create_reserved_r(&_slab_arena, config, count, span);
+}
+
+int mm_slab_arena_destroy(void)
+{
+	int err;
+
+	err = mm_slab_arena_destroy_r(_slab_arena);
+	if (!err)
+		_slab_arena = NULL;
+
+	return err;
+}
+
+__attribute__((__malloc__(mm_slab_arena_free, 1)))
+void *mm_slab_arena_malloc(size_t size)
+{
+	return mm_slab_arena_malloc_r(_slab_arena, size);
+}
+
+int mm_slab_arena_spill(unsigned int classes)
+{
+	return mm_slab_arena_spill_r(_slab_arena, classes);
+}
+
+__attribute__((__malloc__(mm_slab_arena_free, 1)))
+void *mm_slab_arena_calloc(size_t nmemb, size_t size)
+{
+	return mm_slab_arena_calloc_r(_slab_arena, nmemb, size);
+}
+
+void *mm_slab_arena_realloc(void *ptr, size_t size)
+{
+	return mm_slab_arena_realloc_r(_slab_arena, ptr, size);
+}
+
+int mm_slab_arena_free(void *ptr)
+{
+	return mm_slab_arena_free_r(_slab_arena, ptr);
+}
+
+int mm_slab_arena_tcache(unsigned int count)
+{
+	return mm_slab_arena_tcache_r(_slab_arena, count);
+}
+
+int mm_slab_arena_tcache_flush(void)
+{
+	return mm_slab_arena_tcache_flush_r(_slab_arena);
+}
+
+int mm_slab_arena_foreach(mm_slab_foreach_t cb, void *ctx)
+{
+	return mm_slab_arena_foreach_r(_slab_arena, cb, ctx);
+}
+
+ssize_t mm_slab_arena_reclaim(size_t limit)
+{
+	return mm_slab_arena_reclaim_r(_slab_arena, limit);
+}
+
+ssize_t mm_slab_arena_adapt(size_t budget)
+{
+	return mm_slab_arena_adapt_r(_slab_arena, budget);
+}
+
+int mm_slab_arena_get_config(struct mm_slab_arena_config **config, size_t *count)
+{
+	return mm_slab_arena_get_config_r(_slab_arena, config, count);
+}
+
+int mm_slab_arena_stats(struct mm_slab_arena_stats **stats, size_t *count)
+{
+	return mm_slab_arena_stats_r(_slab_arena, stats, count);
+}
@@ -0,0 +1,264 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mm/config/cdefs.h>
+#include <mm/config/config.h>
+
+#include <mm/slab_arena.h>
+#include <mm/alloc.h>
+
+/* --------------------------------------------------------------------------
+ * INTERNAL TYPES
+ * -------------------------------------------------------------------------- */
+
+/* Sizes sharing the same element size once rounded up to MM_ALIGN */
+struct _plan_unit {
+	size_t esize;
+	size_t count;
+	size_t bytes;
+};
+
+struct _plan {
+	struct _plan_unit *unit;
+	size_t nunits;
+	size_t classes;
+	size_t *cost; /* [classes + 1][nunits + 1], SIZE_MAX if unreachable */
+	size_t *from;
+	size_t *pc; /* Prefix sums of the counts */
+	size_t *pb; /* Prefix sums of the bytes */
+};
+
+#define _PLAN_AT(plan, k, i) ((k) * ((plan)->nunits + 1) + (i))
+
+/* Largest number of units solved, the solve is in O(classes * units^2) */
+#define _PLAN_UNITS 256
+
+/* --------------------------------------------------------------------------
+ * LOCAL FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+static int _plan_size_cmp(const void *a, const void *b)
+{
+	const struct mm_slab_arena_size *sa = a, *sb = b;
+
+	return (sa->size > sb->size) - (sa->size < sb->size);
+}
+
+/* Halve the units, two neighbours merged into one of the larger element size */
+static void _plan_coarsen(struct _plan *plan)
+{
+	size_t i, n = 0;
+
+	for (i = 0; i < plan->nunits; i += 2) {
+		struct _plan_unit unit = plan->unit[i];
+
+		if (i + 1 < plan->nunits) {
+			unit.esize = plan->unit[i + 1].esize;
+			unit.count += plan->unit[i + 1].count;
+			unit.bytes += plan->unit[i + 1].bytes;
+		}
+		plan->unit[n++] = unit;
+	}
+
+	plan->nunits = n;
+}
+
+/*
+ * Smallest footprint of the units, the @a drop largest objects left to the
+ * heap, in at most plan->classes classes. A class made of the units (j, i]
+ * has the element size of unit i and the objects of all of them: its waste is
+ * what the smaller units lose to rounding.
+ */
+static size_t _plan_solve(struct _plan *plan, size_t drop, size_t *classes)
+{
+	size_t i, j, k, u, best = SIZE_MAX;
+
+	plan->pc[0] = 0;
+	plan->pb[0] = 0;
+	for (u = plan->nunits; u > 0; u--) {
+		struct _plan_unit *unit = &plan->unit[u - 1];
+		size_t cut = drop < unit->count ? drop : unit->count;
+
+		drop -= cut;
+		plan->pc[u] = unit->count - cut;
+		plan->pb[u] = unit->count ? (unit->bytes / unit->count) * (unit->count - cut) : 0;
+	}
+	for (u = 1; u <= plan->nunits; u++) {
+		plan->pc[u] += plan->pc[u - 1];
+		plan->pb[u] += plan->pb[u - 1];
+	}
+
+	for (i = 0; i <= plan->nunits; i++)
+		plan->cost[_PLAN_AT(plan, 0, i)] = i && plan->pc[i] ? SIZE_MAX : 0;
+
+	for (k = 1; k <= plan->classes; k++) {
+		for (i = 0; i <= plan->nunits; i++) {
+			size_t c = plan->cost[_PLAN_AT(plan, k - 1, i)];
+
+			/* Fewer classes are as good, units without object cost nothing */
+			plan->from[_PLAN_AT(plan, k, i)] = i;
+			for (j = 0; j < i; j++) {
+				size_t prev = plan->cost[_PLAN_AT(plan, k - 1, j)];
+				size_t n = plan->pc[i] - plan->pc[j];
+				size_t cj;
+
+				if (prev == SIZE_MAX)
+					continue;
+
+				cj = prev + plan->unit[i - 1].esize * n - (plan->pb[i] - plan->pb[j]);
+				if (cj < c) {
+					c = cj;
+					plan->from[_PLAN_AT(plan, k, i)] = j;
+				}
+			}
+			plan->cost[_PLAN_AT(plan, k, i)] = c;
+		}
+	}
+
+	for (k = 0; k <= plan->classes; k++) {
+		size_t c = plan->cost[_PLAN_AT(plan, k, plan->nunits)];
+
+		if (c < best) {
+			best = c;
+			*classes = k;
+		}
+	}
+
+	/* Waste plus the size of the provisioned objects */
+	return best == SIZE_MAX ? best : best + plan->pb[plan->nunits];
+}
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+int mm_slab_arena_plan(const struct mm_slab_arena_size *hist, size_t n, size_t budget, double miss,
+		       size_t classes, struct mm_slab_arena_config **config, size_t *count)
+{
+	struct mm_slab_arena_size *sorted = NULL;
+	struct mm_slab_arena_config *c = NULL;
+	struct _plan plan = { 0 };
+	size_t i, k, total = 0, lo, hi, used, footprint;
+	int err = -ENOMEM;
+
+	if (!hist || !n || !budget || miss < 0.0 || miss > 1.0 || !classes || !config || !count)
+		return -EINVAL;
+
+	sorted = mm_malloc(n * sizeof(struct mm_slab_arena_size));
+	plan.unit = mm_calloc(n, sizeof(struct _plan_unit));
+	plan.classes = classes;
+	if (!sorted || !plan.unit)
+		goto out;
+
+	memcpy(sorted, hist, n * sizeof(struct mm_slab_arena_size));
+	qsort(sorted, n, sizeof(struct mm_slab_arena_size), _plan_size_cmp);
+
+	for (i = 0; i < n; i++) {
+		size_t esize = ROUNDUP(sorted[i].size ? sorted[i].size : 1, MM_ALIGN);
+		struct _plan_unit *unit;
+
+		if (!sorted[i].count)
+			continue;
+
+		if (!plan.nunits || plan.unit[plan.nunits - 1].esize != esize)
+			plan.nunits++;
+
+		unit = &plan.unit[plan.nunits - 1];
+		unit->esize = esize;
+		unit->count += sorted[i].count;
+		unit->bytes += sorted[i].size * sorted[i].count;
+		total += sorted[i].count;
+	}
+
+	err = -EINVAL;
+	if (!total)
+		goto out;
+
+	/* Many sizes share coarser classes, at the cost of some rounding */
+	while (plan.nunits > _PLAN_UNITS)
+		_plan_coarsen(&plan);
+
+	err = -ENOMEM;
+	plan.cost = mm_calloc((classes + 1) * (plan.nunits + 1), sizeof(size_t));
+	plan.from = mm_calloc((classes + 1) * (plan.nunits + 1), sizeof(size_t));
+	plan.pc = mm_calloc(plan.nunits + 1, sizeof(size_t));
+	plan.pb = mm_calloc(plan.nunits + 1, sizeof(size_t));
+	if (!plan.cost || !plan.from || !plan.pc || !plan.pb)
+		goto out;
+
+	/* Fewest objects left to the heap for the classes to fit the budget */
+	lo = 0;
+	hi = total;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (_plan_solve(&plan, mid, &used) <= budget)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	err = -ENOSPC;
+	if ((double)lo > miss * (double)total)
+		goto out;
+
+	footprint = _plan_solve(&plan, lo, &used);
+	if (footprint > budget)
+		goto out;
+
+	err = -ENOMEM;
+	c = mm_calloc(used ? used : 1, sizeof(struct mm_slab_arena_config));
+	if (!c)
+		goto out;
+
+	/* Walk the classes back from the largest units */
+	i = plan.nunits;
+	for (k = used; k > 0; k--) {
+		size_t j = plan.from[_PLAN_AT(&plan, k, i)];
+
+		if (j == i)
+			continue;
+
+		c[k - 1].esize = plan.unit[i - 1].esize;
+		c[k - 1].ecount = plan.pc[i] - plan.pc[j];
+		i = j;
+	}
+
+	/* Drop the classes left empty, by fewer classes or by the heap */
+	for (i = 0, k = 0; i < used; i++)
+		if (c[i].ecount)
+			c[k++] = c[i];
+
+	*config = c;
+	*count = k;
+	err = k;
+	c = NULL;
+
+out:
+	/* mm_free(NULL) is not a no-op with memory tracking */
+	if (c)
+		mm_free(c);
+	if (plan.pb)
+		mm_free(plan.pb);
+	if (plan.pc)
+		mm_free(plan.pc);
+	if (plan.from)
+		mm_free(plan.from);
+	if (plan.cost)
+		mm_free(plan.cost);
+	if (plan.unit)
+		mm_free(plan.unit);
+	if (sorted)
+		mm_free(sorted);
+
+	return err;
+}
@@ -0,0 +1,136 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <mm/config/config.h>
+#include <mm/config/thread.h>
+
+#include <mm/alloc.h>
+#include <mm/slab.h>
+#include <mm/slab_reclaim.h>
+
+/* --------------------------------------------------------------------------
+ * INTERNAL TYPES
+ * -------------------------------------------------------------------------- */
+
+/* Longest sleep between two checks of the stop request */
+#define _RECLAIM_TICK_MS 10u
+
+struct mm_slab_reclaimer {
+	THREAD_TYPE thread;
+	atomic_bool stop;
+	atomic_size_t bytes;
+	unsigned int period_ms;
+	size_t rate;
+	size_t count;
+	struct mm_slab *slabs[];
+};
+
+/* --------------------------------------------------------------------------
+ * LOCAL FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+static void _reclaim_sleep(struct mm_slab_reclaimer *r)
+{
+	unsigned int left = r->period_ms;
+
+	while (left && !atomic_load_explicit(&r->stop, memory_order_relaxed)) {
+		unsigned int ms = left < _RECLAIM_TICK_MS ? left : _RECLAIM_TICK_MS;
+		struct timespec ts = {
+			.tv_sec = 0,
+			.tv_nsec = ms * 1000000l,
+		};
+
+		nanosleep(&ts, NULL);
+		left -= ms;
+	}
+}
+
+static void *_reclaim_thread(void *arg)
+{
+	struct mm_slab_reclaimer *r = arg;
+
+	while (!atomic_load_explicit(&r->stop, memory_order_relaxed)) {
+		size_t bytes = 0;
+		size_t i;
+
+		/* The rate is shared by every pool of a period */
+		for (i = 0; i < r->count && (!r->rate || bytes < r->rate); i++) {
+			ssize_t ret = mm_slab_reclaim(r->slabs[i], r->rate ? r->rate - bytes : 0);
+
+			if (ret > 0)
+				bytes += ret;
+		}
+
+		atomic_fetch_add_explicit(&r->bytes, bytes, memory_order_relaxed);
+
+		_reclaim_sleep(r);
+	}
+
+	return NULL;
+}
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+struct mm_slab_reclaimer *mm_slab_reclaimer_start(struct mm_slab **slabs, size_t count,
+						  unsigned int period_ms, size_t rate)
+{
+	struct mm_slab_reclaimer *r;
+
+	if (!slabs || !count || !period_ms)
+		return NULL;
+
+	r = mm_malloc(sizeof(struct mm_slab_reclaimer) + count * sizeof(struct mm_slab *));
+	if (!r)
+		return NULL;
+
+	atomic_init(&r->stop, false);
+	atomic_init(&r->bytes, 0);
+	r->period_ms = period_ms;
+	r->rate = rate;
+	r->count = count;
+	memcpy(r->slabs, slabs, count * sizeof(struct mm_slab *));
+
+	if (THREAD_CREATE(r->thread, _reclaim_thread, r) != 0) {
+		mm_free(r);
+		return NULL;
+	}
+
+	return r;
+}
+
+ssize_t mm_slab_reclaimer_bytes(struct mm_slab_reclaimer *reclaimer)
+{
+	if (!reclaimer)
+		return -EINVAL;
+
+	return atomic_load_explicit(&reclaimer->bytes, memory_order_relaxed);
+}
+
+ssize_t mm_slab_reclaimer_stop(struct mm_slab_reclaimer *reclaimer)
+{
+	ssize_t bytes;
+
+	if (!reclaimer)
+		return -EINVAL;
+
+	atomic_store_explicit(&reclaimer->stop, true, memory_order_relaxed);
+	(void)THREAD_JOIN(reclaimer->thread);
+
+	bytes = atomic_load_explicit(&reclaimer->bytes, memory_order_relaxed);
+	mm_free(reclaimer);
+
+	return bytes;
+}
@@ -0,0 +1,221 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <mm/config/config.h>
+
+#include <mm/alloc.h>
+#include <mm/slab.h>
+#include <mm/slotmap.h>
+
+/* --------------------------------------------------------------------------
+ * INTERNAL TYPES
+ * -------------------------------------------------------------------------- */
+
+#define MM_SLOTMAP_MAGIC 0x534c4f54 /* SLOT in ascii */
+
+/*
+ * Generations are even while a slot is free and odd while it is allocated, so
+ * that only handles to live objects match.
+ */
+struct mm_slotmap {
+	uint32_t magic;
+	unsigned int shift; /* Index bits */
+	uint64_t mask; /* Index mask */
+	uint32_t gmask; /* Generation mask */
+	size_t ecount;
+
+	/* Element addresses, cached from the pool for lookups */
+	uintptr_t base;
+	size_t stride;
+
+	struct mm_slab *slab;
+	uint32_t *gen;
+};
+
+/* --------------------------------------------------------------------------
+ * LOCAL FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+static inline mm_slotmap_handle_t _slotmap_handle(struct mm_slotmap *map, size_t idx)
+{
+	return ((mm_slotmap_handle_t)map->gen[idx] << map->shift) | idx;
+}
+
+/* Index of a handle to a live object, -ESTALE or -EINVAL otherwise */
+static inline ssize_t _slotmap_index(struct mm_slotmap *map, mm_slotmap_handle_t handle)
+{
+	mm_slotmap_handle_t gen = handle >> map->shift;
+	size_t idx = handle & map->mask;
+
+	/* Even generations are never handed out */
+	if (idx >= map->ecount || gen > map->gmask || !(gen & 1))
+		return -EINVAL;
+
+	if (map->gen[idx] != gen)
+		return -ESTALE;
+
+	return idx;
+}
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+struct mm_slotmap *mm_slotmap_create(const struct mm_slotmap_config *config)
+{
+	struct mm_slotmap *map;
+	unsigned int bits, shift = 0;
+
+	/* Generations are not kept in a file-backed pool */
+	if (!config || !config->slab.ecount || config->slab.path)
+		return NULL;
+
+	bits = config->handle_bits ? config->handle_bits : 64;
+	if (bits != 32 && bits != 64)
+		return NULL;
+
+	while (shift < 64 && (config->slab.ecount - 1) >> shift)
+		shift++;
+
+	/* Room for the generation, which never needs more than 32 bits */
+	if (shift + 2 > bits)
+		return NULL;
+
+	map = mm_malloc(sizeof(struct mm_slotmap));
+	if (!map)
+		return NULL;
+
+	map->magic = MM_SLOTMAP_MAGIC;
+	map->shift = shift;
+	map->mask = (UINT64_C(1) << shift) - 1;
+	map->gmask = bits - shift >= 32 ? UINT32_MAX : (UINT32_C(1) << (bits - shift)) - 1;
+	map->ecount = config->slab.ecount;
+
+	map->gen = mm_calloc(map->ecount, sizeof(uint32_t));
+	if (!map->gen)
+		goto err_map;
+
+	map->slab = mm_slab_create_config(&config->slab);
+	if (!map->slab)
+		goto err_gen;
+
+	map->base = (uintptr_t)mm_slab_ptr(map->slab, 0);
+	map->stride = map->ecount > 1 ? (uintptr_t)mm_slab_ptr(map->slab, 1) - map->base : 0;
+
+	return map;
+
+err_gen:
+	mm_free(map->gen);
+err_map:
+	mm_free(map);
+	return NULL;
+}
+
+int mm_slotmap_destroy(struct mm_slotmap *map)
+{
+	int err;
+
+	if (!map)
+		return -EINVAL;
+
+	if (map->magic != MM_SLOTMAP_MAGIC)
+		return -EIO;
+
+	err = mm_slab_destroy(map->slab);
+	if (err < 0)
+		return err;
+
+	map->magic = 0;
+	mm_free(map->gen);
+	mm_free(map);
+
+	return 0;
+}
+
+void *mm_slotmap_alloc(struct mm_slotmap *map, mm_slotmap_handle_t *handle)
+{
+	void *obj;
+	size_t idx;
+
+	if (!map || !handle || map->magic != MM_SLOTMAP_MAGIC)
+		return NULL;
+
+	obj = mm_slab_alloc(map->slab);
+	if (!obj)
+		return NULL;
+
+	idx = mm_slab_index(map->slab, obj);
+	map->gen[idx] = (map->gen[idx] + 1) & map->gmask;
+	*handle = _slotmap_handle(map, idx);
+
+	return obj;
+}
+
+int mm_slotmap_free(struct mm_slotmap *map, mm_slotmap_handle_t handle)
+{
+	ssize_t idx;
+	int err;
+
+	if (!map)
+		return -EINVAL;
+
+	if (map->magic != MM_SLOTMAP_MAGIC)
+		return -EIO;
+
+	idx = _slotmap_index(map, handle);
+	if (idx < 0)
+		return idx;
+
+	/* Stale from now on, even before the slot is reused */
+	map->gen[idx] = (map->gen[idx] + 1) & map->gmask;
+
+	err = mm_slab_free(map->slab, (void *)(map->base + idx * map->stride));
+	if (err < 0)
+		map->gen[idx] = (map->gen[idx] - 1) & map->gmask;
+
+	return err;
+}
+
+void *mm_slotmap_get(struct mm_slotmap *map, mm_slotmap_handle_t handle)
+{
+	ssize_t idx;
+
+	if (!map)
+		return NULL;
+
+	idx = _slotmap_index(map, handle);
+	if (idx < 0)
+		return NULL;
+
+	return (void *)(map->base + idx * map->stride);
+}
+
+mm_slotmap_handle_t mm_slotmap_handle(struct mm_slotmap *map, const void *obj)
+{
+	ssize_t idx;
+
+	if (!map || !obj || map->magic != MM_SLOTMAP_MAGIC)
+		return 0;
+
+	idx = mm_slab_index(map->slab, obj);
+	if (idx < 0 || !(map->gen[idx] & 1))
+		return 0;
+
+	return _slotmap_handle(map, idx);
+}
+
+struct mm_slab *mm_slotmap_slab(struct mm_slotmap *map)
+{
+	if (!map || map->magic != MM_SLOTMAP_MAGIC)
+		return NULL;
+
+	return map->slab;
+}
@@ -0,0 +1,114 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include <mm/numa.h>
+#include <mm/page.h>
+#include <mm/slab.h>
+#include <mm/slab_arena.h>
+
+TEST(NumaTest, Nodes)
+{
+	int count = mm_numa_node_count();
+
+	EXPECT_GE(count, 1);
+	EXPECT_GE(mm_numa_current_node(), 0);
+	EXPECT_LT(mm_numa_current_node(), 64);
+}
+
+TEST(NumaTest, Apply)
+{
+	struct mm_numa policies[] = {
+		{ MM_NUMA_DEFAULT, 0 },
+		{ MM_NUMA_LOCAL, 0 },
+		{ MM_NUMA_NODE, mm_numa_current_node() },
+		{ MM_NUMA_INTERLEAVE, 0 },
+	};
+
+	for (auto &numa : policies) {
+		size_t size = 4 * mm_page_size();
+		void *addr = mm_page_map(&size, 0);
+		ASSERT_NE(addr, nullptr);
+
+		EXPECT_EQ(mm_numa_apply(addr, size, &numa), 0);
+		memset(addr, 0, size);
+
+		EXPECT_EQ(mm_page_unmap(addr, size), 0);
+	}
+}
+
+TEST(NumaTest, ApplyInvalid)
+{
+	struct mm_numa numa = { MM_NUMA_NODE, -1 };
+	size_t size = mm_page_size();
+	void *addr = mm_page_map(&size, 0);
+	ASSERT_NE(addr, nullptr);
+
+	EXPECT_EQ(mm_numa_apply(nullptr, size, nullptr), -EINVAL);
+	EXPECT_EQ(mm_numa_apply(addr, size, nullptr), 0);
+	EXPECT_EQ(mm_numa_apply(addr, size, &numa), -EINVAL);
+
+	numa.node = mm_numa_node_count();
+	EXPECT_LT(mm_numa_apply(addr, size, &numa), 0);
+
+	EXPECT_EQ(mm_page_unmap(addr, size), 0);
+}
+
+TEST(NumaTest, SlabPlacement)
+{
+	struct mm_slab_config config = {};
+
+	config.esize = 512;
+	config.ecount = 128;
+	config.numa.policy = MM_NUMA_LOCAL;
+
+	struct mm_slab *slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+
+	void *ptr = mm_slab_alloc(slab);
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ((uintptr_t)ptr % mm_page_size(), 0);
+	memset(ptr, 0, 512);
+	EXPECT_EQ(mm_slab_free(slab, ptr), 0);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+
+	// A node that does not exist makes the creation fail
+	config.numa.policy = MM_NUMA_NODE;
+	config.numa.node = mm_numa_node_count();
+	EXPECT_EQ(mm_slab_create_config(&config), nullptr);
+}
+
+TEST(NumaTest, ArenaPlacement)
+{
+	struct mm_slab_arena_config config[2] = {};
+
+	config[0].esize = 64;
+	config[0].ecount = 64;
+	config[0].numa.policy = MM_NUMA_INTERLEAVE;
+	config[1].esize = 4096;
+	config[1].ecount = 16;
+	config[1].numa.policy = MM_NUMA_NODE;
+	config[1].numa.node = 0;
+
+	ASSERT_EQ(mm_slab_arena_create(config, 2), 0);
+
+	void *small = mm_slab_arena_malloc(48);
+	void *large = mm_slab_arena_malloc(4000);
+	ASSERT_NE(small, nullptr);
+	ASSERT_NE(large, nullptr);
+	memset(small, 0, 48);
+	memset(large, 0, 4000);
+
+	EXPECT_EQ(mm_slab_arena_free(small), 0);
+	EXPECT_EQ(mm_slab_arena_free(large), 0);
+	EXPECT_EQ(mm_slab_arena_destroy(), 0);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,242 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include <mm/config/config.h>
+#include <mm/page.h>
+#include <mm/slab.h>
+
+TEST(PageTest, MapAndUnmap)
+{
+	size_t page = mm_page_size();
+	size_t size = 3 * page + 1;
+
+	void *addr = mm_page_map(&size, 0);
+	ASSERT_NE(addr, nullptr);
+	EXPECT_EQ((uintptr_t)addr % page, 0);
+	EXPECT_EQ(size, 4 * page);
+	memset(addr, 0x5a, size);
+
+	EXPECT_EQ(mm_page_unmap(addr, size), 0);
+}
+
+// Huge pages are best effort: the mapping succeeds even without them
+TEST(PageTest, MapHuge)
+{
+	size_t size = MM_HUGEPAGE_SIZE + 1;
+
+	void *addr = mm_page_map(&size, MM_PAGE_F_HUGE);
+	ASSERT_NE(addr, nullptr);
+	EXPECT_EQ((uintptr_t)addr % MM_HUGEPAGE_SIZE, 0);
+	EXPECT_EQ(size, 2 * MM_HUGEPAGE_SIZE);
+	memset(addr, 0x5a, size);
+
+	EXPECT_EQ(mm_page_unmap(addr, size), 0);
+}
+
+TEST(PageTest, Release)
+{
+	size_t page = mm_page_size();
+	size_t size = 4 * page;
+
+	uint8_t *addr = (uint8_t *)mm_page_map(&size, 0);
+	ASSERT_NE(addr, nullptr);
+	memset(addr, 0x5a, size);
+
+	EXPECT_EQ(mm_page_release(addr + page, 2 * page), 0);
+	EXPECT_EQ(addr[0], 0x5a);
+	EXPECT_EQ(addr[page], 0);
+	EXPECT_EQ(addr[3 * page - 1], 0);
+	EXPECT_EQ(addr[3 * page], 0x5a);
+
+	EXPECT_EQ(mm_page_release(addr + 1, page), -EINVAL);
+	EXPECT_EQ(mm_page_release(addr, page + 1), -EINVAL);
+	EXPECT_EQ(mm_page_release(nullptr, page), -EINVAL);
+
+	EXPECT_EQ(mm_page_unmap(addr, size), 0);
+}
+
+TEST(PageTest, Reserve)
+{
+	size_t page = mm_page_size();
+	size_t size = 4 * page - 1;
+
+	EXPECT_EQ(mm_page_reserve(&size, 3 * page, 0), nullptr);
+
+	uint8_t *addr = (uint8_t *)mm_page_reserve(&size, 4 * page, 0);
+	ASSERT_NE(addr, nullptr);
+	EXPECT_EQ(size, 4 * page);
+	EXPECT_EQ((uintptr_t)addr % (4 * page), 0U);
+	EXPECT_EQ(mm_page_resident(addr, size), 0);
+
+	EXPECT_EQ(mm_page_commit(addr + page, 2 * page), 0);
+	memset(addr + page, 0x5a, 2 * page);
+	EXPECT_EQ(mm_page_resident(addr, size), (ssize_t)(2 * page));
+
+	EXPECT_EQ(mm_page_decommit(addr + 2 * page, page), 0);
+	EXPECT_EQ(mm_page_resident(addr, size), (ssize_t)page);
+
+	EXPECT_EQ(mm_page_commit(addr + 1, page), -EINVAL);
+	EXPECT_EQ(mm_page_decommit(addr, page + 1), -EINVAL);
+
+	EXPECT_EQ(mm_page_unmap(addr, size), 0);
+}
+
+TEST(PageTest, Invalid)
+{
+	size_t size = 0;
+
+	EXPECT_EQ(mm_page_map(nullptr, 0), nullptr);
+	EXPECT_EQ(mm_page_map(&size, 0), nullptr);
+	EXPECT_EQ(mm_page_unmap(nullptr, 4096), -EINVAL);
+}
+
+TEST(PageTest, SlabOnPages)
+{
+	struct mm_slab_config config = {};
+	void *ptrs[64];
+
+	config.alignment = 64;
+	config.esize = 1024;
+	config.ecount = 64;
+	config.flags = MM_SLAB_F_HUGEPAGE;
+
+	struct mm_slab *slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+
+	EXPECT_EQ(mm_slab_alloc_bulk(slab, ptrs, 64), 64);
+	EXPECT_EQ((uintptr_t)ptrs[0] % MM_HUGEPAGE_SIZE, 0);
+	for (int i = 0; i < 64; i++)
+		memset(ptrs[i], i, 1024);
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 64), 0);
+
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
+struct provider_calls {
+	int map;
+	int unmap;
+};
+
+static void *counting_map(void *ctx, size_t *size, unsigned int flags)
+{
+	struct provider_calls *calls = (struct provider_calls *)ctx;
+
+	calls->map++;
+	return mm_page_map(size, flags);
+}
+
+static void counting_unmap(void *ctx, void *addr, size_t size)
+{
+	struct provider_calls *calls = (struct provider_calls *)ctx;
+
+	calls->unmap++;
+	mm_page_unmap(addr, size);
+}
+
+TEST(PageTest, Prefault)
+{
+	size_t page = mm_page_size();
+	size_t size = 16 * page;
+	size_t faults = 0;
+
+	unsigned char *addr = (unsigned char *)mm_page_map(&size, 0);
+	ASSERT_NE(addr, nullptr);
+	addr[page + 3] = 0x5a;
+
+	// Untouched pages fault once, content is kept
+	EXPECT_EQ(mm_page_prefault(addr, size, &faults), 0);
+	EXPECT_GE(faults, 15);
+	EXPECT_EQ(addr[page + 3], 0x5a);
+
+	EXPECT_EQ(mm_page_prefault(addr, size, &faults), 0);
+	EXPECT_EQ(faults, 0);
+
+	EXPECT_EQ(mm_page_prefault(nullptr, size, &faults), -EINVAL);
+	EXPECT_EQ(mm_page_unmap(addr, size), 0);
+}
+
+TEST(PageTest, SlabPrefault)
+{
+	struct mm_slab_config config = {};
+	struct mm_slab *slab;
+	size_t prefaulted, faults, locked;
+
+	config.alignment = 64;
+	config.esize = 256;
+	config.ecount = 1024;
+	config.flags = MM_SLAB_F_PAGES | MM_SLAB_F_PREFAULT;
+
+	slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+	EXPECT_EQ(mm_slab_mem_stats(slab, &prefaulted, &faults, &locked), 0);
+	EXPECT_EQ(prefaulted, 256 * 1024);
+	EXPECT_GE(faults, 256 * 1024 / mm_page_size());
+	EXPECT_EQ(locked, 0);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+
+	// Pools created without the flag fault lazily
+	config.flags = MM_SLAB_F_PAGES;
+	slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+	EXPECT_EQ(mm_slab_mem_stats(slab, &prefaulted, &faults, &locked), 0);
+	EXPECT_EQ(prefaulted, 0);
+	EXPECT_EQ(faults, 0);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
+TEST(PageTest, SlabLock)
+{
+	struct mm_slab_config config = {};
+	struct mm_slab *slab;
+	size_t prefaulted, locked;
+
+	config.esize = 64;
+	config.ecount = 64;
+	config.flags = MM_SLAB_F_MLOCK;
+
+	slab = mm_slab_create_config(&config);
+	if (!slab)
+		GTEST_SKIP() << "mlock() not permitted";
+
+	EXPECT_EQ(mm_slab_mem_stats(slab, &prefaulted, nullptr, &locked), 0);
+	EXPECT_EQ(prefaulted, 64 * 64);
+	EXPECT_EQ(locked, 64 * 64);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
+TEST(PageTest, CustomProvider)
+{
+	struct provider_calls calls = { 0, 0 };
+	struct mm_page_provider provider = {};
+	struct mm_slab_config config = {};
+
+	provider.map = counting_map;
+	provider.unmap = counting_unmap;
+	provider.ctx = &calls;
+
+	config.esize = 256;
+	config.ecount = 32;
+	config.provider = &provider;
+
+	struct mm_slab *slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+	EXPECT_EQ(calls.map, 1);
+
+	void *ptr = mm_slab_alloc(slab);
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ((uintptr_t)ptr % mm_page_size(), 0);
+	EXPECT_EQ(mm_slab_free(slab, ptr), 0);
+
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+	EXPECT_EQ(calls.unmap, 1);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
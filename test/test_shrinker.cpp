@@ -0,0 +1,179 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <mm/alloc.h>
+#include <mm/shrinker.h>
+#include <mm/track.h>
+
+#define BLOCK 1024
+#define BLOCKS 64
+
+// An application cache of heap blocks
+struct cache {
+	void *blocks[BLOCKS];
+	int count;
+	int scans;
+};
+
+static size_t cache_count(void *ctx)
+{
+	struct cache *c = (struct cache *)ctx;
+
+	return c->count * BLOCK;
+}
+
+static size_t cache_scan(void *ctx, size_t target)
+{
+	struct cache *c = (struct cache *)ctx;
+	size_t freed = 0;
+
+	c->scans++;
+	while (c->count && freed < target) {
+		mm_free(c->blocks[--c->count]);
+		freed += BLOCK;
+	}
+
+	return freed;
+}
+
+// Test fixture for shrinkers
+class ShrinkerTest : public ::testing::Test {
+    protected:
+	struct cache caches[2] = {};
+	struct mm_shrinker shrinkers[2] = {};
+
+	void SetUp() override
+	{
+		ASSERT_EQ(mm_mt_activate(), 0);
+
+		for (int i = 0; i < 2; i++) {
+			shrinkers[i].count = cache_count;
+			shrinkers[i].scan = cache_scan;
+			shrinkers[i].ctx = &caches[i];
+			ASSERT_EQ(mm_shrinker_register(&shrinkers[i]), 0);
+		}
+	}
+
+	void TearDown() override
+	{
+		mm_shrinker_set_heap(0);
+		mm_shrinker_set_cgroup(nullptr, 0);
+
+		for (int i = 0; i < 2; i++) {
+			EXPECT_EQ(mm_shrinker_unregister(&shrinkers[i]), 0);
+			while (caches[i].count)
+				mm_free(caches[i].blocks[--caches[i].count]);
+		}
+
+		mm_mt_deactivate();
+	}
+
+	void fill(struct cache *c, int count)
+	{
+		while (c->count < count)
+			c->blocks[c->count++] = mm_malloc(BLOCK);
+	}
+};
+
+TEST_F(ShrinkerTest, Register)
+{
+	struct mm_shrinker none = {};
+
+	EXPECT_EQ(mm_shrinker_register(nullptr), -EINVAL);
+	EXPECT_EQ(mm_shrinker_register(&none), -EINVAL);
+	EXPECT_EQ(mm_shrinker_unregister(&none), -ENOENT);
+}
+
+TEST_F(ShrinkerTest, Proportional)
+{
+	fill(&caches[0], 48);
+	fill(&caches[1], 16);
+
+	EXPECT_GE(mm_shrink(32 * BLOCK), 32 * BLOCK);
+	EXPECT_EQ(caches[0].count, 24);
+	EXPECT_EQ(caches[1].count, 8);
+
+	// Everything
+	EXPECT_EQ(mm_shrink(0), 32 * BLOCK);
+	EXPECT_EQ(caches[0].count + caches[1].count, 0);
+}
+
+TEST_F(ShrinkerTest, Heap)
+{
+	size_t base = mm_malloc_info().uallocated;
+	void *extra[2];
+
+	fill(&caches[0], 32);
+	mm_shrinker_set_heap(base + 32 * BLOCK + BLOCK / 2);
+
+	// Crossing the threshold shrinks down to 7/8 of it, once polled
+	extra[0] = mm_malloc(BLOCK);
+	EXPECT_EQ(caches[0].scans, 0);
+	EXPECT_GT(mm_shrinker_poll(), 0);
+	EXPECT_EQ(caches[0].scans, 1);
+	EXPECT_LE(mm_malloc_info().uallocated, base + 29 * BLOCK);
+	EXPECT_GE(caches[0].count, 27);
+
+	// Not again until the usage went down
+	fill(&caches[0], 32);
+	extra[1] = mm_malloc(BLOCK);
+	EXPECT_EQ(mm_shrinker_poll(), 0);
+	EXPECT_EQ(caches[0].scans, 1);
+
+	mm_free(extra[1]);
+	mm_free(extra[0]);
+	while (caches[0].count > 20)
+		mm_free(caches[0].blocks[--caches[0].count]);
+
+	fill(&caches[0], 32);
+	extra[0] = mm_malloc(BLOCK);
+	EXPECT_GT(mm_shrinker_poll(), 0);
+	EXPECT_EQ(caches[0].scans, 2);
+	mm_free(extra[0]);
+}
+
+TEST_F(ShrinkerTest, Cgroup)
+{
+	char dir[] = "/tmp/test_shrinker.XXXXXX";
+	char path[64];
+	FILE *f;
+
+	ASSERT_NE(mkdtemp(dir), nullptr);
+	ASSERT_EQ(mm_shrinker_set_cgroup(dir, 50), 0);
+
+	// No memory controller
+	EXPECT_EQ(mm_shrinker_poll(), -ENOENT);
+
+	snprintf(path, sizeof(path), "%s/memory.max", dir);
+	f = fopen(path, "w");
+	ASSERT_NE(f, nullptr);
+	fprintf(f, "%d\n", 100 * BLOCK);
+	fclose(f);
+
+	snprintf(path, sizeof(path), "%s/memory.current", dir);
+	f = fopen(path, "w");
+	ASSERT_NE(f, nullptr);
+	fprintf(f, "%d\n", 60 * BLOCK);
+	fclose(f);
+
+	fill(&caches[0], 32);
+	EXPECT_GT(mm_shrinker_poll(), 0);
+	EXPECT_LE(caches[0].count, 32 - (60 * BLOCK - 50 * BLOCK * 7 / 8) / BLOCK);
+
+	unlink(path);
+	snprintf(path, sizeof(path), "%s/memory.max", dir);
+	unlink(path);
+	rmdir(dir);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -63,6 +63,143 @@ TEST_F(SlabTest, MultipleAllocAndFree)
 	}
 }
 
+// Test case for mm_slab_alloc_bulk and mm_slab_free_bulk
+TEST_F(SlabTest, BulkAllocAndFree)
+{
+	void *ptrs[12];
+	size_t allocated, missed, freed;
+
+	int result = mm_slab_alloc_bulk(slab, ptrs, 4);
+	EXPECT_EQ(result, 4);
+
+	// Only 6 left in the pool
+	result = mm_slab_alloc_bulk(slab, &ptrs[4], 8);
+	EXPECT_EQ(result, 6);
+	EXPECT_EQ(mm_slab_alloc(slab), nullptr);
+
+	for (int i = 0; i < 10; ++i)
+		for (int j = i + 1; j < 10; ++j)
+			EXPECT_NE(ptrs[i], ptrs[j]);
+
+	result = mm_slab_stats(slab, nullptr, nullptr, &allocated, &missed, nullptr);
+	EXPECT_EQ(result, 0);
+	EXPECT_EQ(allocated, 10);
+	EXPECT_EQ(missed, 3);
+
+	// One invalid pointer: nothing is released
+	void *saved = ptrs[3];
+	ptrs[3] = (void *)0x1;
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 10), -ERANGE);
+	EXPECT_EQ(mm_slab_alloc(slab), nullptr);
+	ptrs[3] = saved;
+
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 10), 0);
+
+	result = mm_slab_stats(slab, nullptr, nullptr, nullptr, nullptr, &freed);
+	EXPECT_EQ(result, 0);
+	EXPECT_EQ(freed, 10);
+
+	result = mm_slab_alloc_bulk(slab, ptrs, 10);
+	EXPECT_EQ(result, 10);
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 10), 0);
+
+	EXPECT_EQ(mm_slab_alloc_bulk(nullptr, ptrs, 1), -EINVAL);
+	EXPECT_EQ(mm_slab_alloc_bulk(slab, nullptr, 1), -EINVAL);
+	EXPECT_EQ(mm_slab_free_bulk(nullptr, ptrs, 1), -EINVAL);
+	EXPECT_EQ(mm_slab_free_bulk(slab, nullptr, 1), -EINVAL);
+}
+
+// Bulk operations spanning several bitmap words
+TEST(SlabBulkTest, MultipleWords)
+{
+	struct mm_slab *slab = mm_slab_create(nullptr, 0, 32, 200);
+	ASSERT_NE(slab, nullptr);
+
+	void *ptrs[200];
+	void *single = mm_slab_alloc(slab);
+	ASSERT_NE(single, nullptr);
+
+	EXPECT_EQ(mm_slab_alloc_bulk(slab, ptrs, 200), 199);
+	EXPECT_EQ(mm_slab_alloc(slab), nullptr);
+
+	// Release every other buffer, then get them back in bulk
+	void *odd[100];
+	int n = 0;
+	for (int i = 1; i < 199; i += 2)
+		odd[n++] = ptrs[i];
+	EXPECT_EQ(mm_slab_free_bulk(slab, odd, n), 0);
+	EXPECT_EQ(mm_slab_alloc_bulk(slab, odd, 100), n);
+
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 199), 0);
+	EXPECT_EQ(mm_slab_free(slab, single), 0);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
+struct visit {
+	struct mm_slab *slab;
+	void *seen[16];
+	int count;
+	int stop_at;
+	bool release;
+};
+
+static int visit_cb(void *obj, void *ctx)
+{
+	struct visit *v = (struct visit *)ctx;
+
+	if (v->count == v->stop_at)
+		return 42;
+
+	v->seen[v->count++] = obj;
+	if (v->release) {
+		EXPECT_EQ(mm_slab_free(v->slab, obj), 0);
+	}
+
+	return 0;
+}
+
+// Test case for mm_slab_foreach
+TEST_F(SlabTest, Foreach)
+{
+	struct visit v = {};
+	void *ptrs[10];
+
+	v.slab = slab;
+	v.stop_at = -1;
+	EXPECT_EQ(mm_slab_foreach(slab, visit_cb, &v), 0);
+	EXPECT_EQ(v.count, 0);
+
+	ASSERT_EQ(mm_slab_alloc_bulk(slab, ptrs, 10), 10);
+	EXPECT_EQ(mm_slab_free(slab, ptrs[2]), 0);
+	EXPECT_EQ(mm_slab_free(slab, ptrs[7]), 0);
+
+	EXPECT_EQ(mm_slab_foreach(slab, visit_cb, &v), 0);
+	ASSERT_EQ(v.count, 8);
+	for (int i = 0, j = 0; i < 10; i++) {
+		if (i == 2 || i == 7)
+			continue;
+		EXPECT_EQ(v.seen[j++], ptrs[i]);
+	}
+
+	// The callback can stop the iteration
+	v.count = 0;
+	v.stop_at = 3;
+	EXPECT_EQ(mm_slab_foreach(slab, visit_cb, &v), 42);
+	EXPECT_EQ(v.count, 3);
+
+	// The callback can release the visited elements
+	v.count = 0;
+	v.stop_at = -1;
+	v.release = true;
+	EXPECT_EQ(mm_slab_foreach(slab, visit_cb, &v), 0);
+	EXPECT_EQ(v.count, 8);
+	EXPECT_EQ(mm_slab_alloc_bulk(slab, ptrs, 10), 10);
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 10), 0);
+
+	EXPECT_EQ(mm_slab_foreach(nullptr, visit_cb, &v), -EINVAL);
+	EXPECT_EQ(mm_slab_foreach(slab, nullptr, &v), -EINVAL);
+}
+
 // Test case for mm_slab_stats
 TEST_F(SlabTest, SlabStats)
 {
@@ -122,6 +259,49 @@ TEST_F(SlabTest, SlabStats)
 	EXPECT_EQ(freed, 1);
 }
 
+// Test case for mm_slab_counters
+TEST(SlabCountersTest, Counters)
+{
+	struct mm_slab *slab = mm_slab_create(nullptr, 0, 32, 200);
+	struct mm_slab_counters c;
+	void *ptrs[200];
+
+	ASSERT_NE(slab, nullptr);
+	EXPECT_EQ(mm_slab_counters(slab, nullptr), -EINVAL);
+
+	for (int i = 0; i < 200; i++)
+		ptrs[i] = mm_slab_alloc(slab);
+	EXPECT_EQ(mm_slab_alloc(slab), nullptr);
+
+	EXPECT_EQ(mm_slab_counters(slab, &c), 0);
+	EXPECT_EQ(c.allocated, 200);
+	EXPECT_EQ(c.missed, 1);
+	EXPECT_EQ(c.inuse, 200);
+	EXPECT_EQ(c.hwm, 200);
+	// Allocations scan the bitmap from its first word
+	size_t words = (200 + 8 * sizeof(long) - 1) / (8 * sizeof(long));
+	EXPECT_GT(c.searched, c.allocated);
+	EXPECT_LE(c.searched, (c.allocated + c.missed) * words);
+
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 150), 0);
+	EXPECT_EQ(mm_slab_free(slab, ptrs[150]), 0);
+	EXPECT_EQ(mm_slab_counters(slab, &c), 0);
+	EXPECT_EQ(c.freed, 151);
+	EXPECT_EQ(c.inuse, 49);
+	EXPECT_EQ(c.hwm, 200);
+
+	EXPECT_EQ(mm_slab_alloc_bulk(slab, ptrs, 10), 10);
+	EXPECT_EQ(mm_slab_counters(slab, &c), 0);
+	EXPECT_EQ(c.inuse, 59);
+	EXPECT_EQ(c.hwm, 200);
+
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 10), 0);
+	EXPECT_EQ(mm_slab_free_bulk(slab, &ptrs[151], 49), 0);
+	EXPECT_EQ(mm_slab_counters(slab, &c), 0);
+	EXPECT_EQ(c.inuse, 0);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
 int main(int argc, char **argv)
 {
 	::testing::InitGoogleTest(&argc, argv);
@@ -4,13 +4,16 @@
 #include <gtest/gtest.h>
 
 #include <mm/alloc.h>
+#include <mm/config/cdefs.h>
+#include <mm/config/config.h>
 #include <mm/slab_arena.h>
 #include <mm/slab.h>
+#include <mm/track.h>
 
 // Test fixture for slab arena tests
 class SlabArenaTest : public ::testing::Test {
 protected:
-	struct mm_slab_arena_config config[2];
+	struct mm_slab_arena_config config[2] = {};
 	size_t count = 2;
 
 	void SetUp() override {
@@ -102,6 +105,39 @@ TEST_F(SlabArenaTest, MultipleCallocAndFree) {
 	EXPECT_EQ(result, 0);
 }
 
+static int count_cb(void *obj, void *ctx)
+{
+	(void)obj;
+	(*(int *)ctx)++;
+
+	return 0;
+}
+
+// Test case for mm_slab_arena_foreach
+TEST_F(SlabArenaTest, Foreach) {
+	int visited = 0;
+
+	EXPECT_EQ(mm_slab_arena_foreach(count_cb, &visited), -EINVAL);
+
+	int result = mm_slab_arena_create(config, count);
+	ASSERT_EQ(result, 0);
+
+	void *small = mm_slab_arena_malloc(100);
+	void *large = mm_slab_arena_malloc(200);
+	void *heap = mm_slab_arena_malloc(1000);
+
+	EXPECT_EQ(mm_slab_arena_foreach(count_cb, &visited), 0);
+	EXPECT_EQ(visited, 2);
+	EXPECT_EQ(mm_slab_arena_foreach(nullptr, nullptr), -EINVAL);
+
+	EXPECT_EQ(mm_slab_arena_free(small), 0);
+	EXPECT_EQ(mm_slab_arena_free(large), 0);
+	EXPECT_EQ(mm_slab_arena_free(heap), 0);
+
+	result = mm_slab_arena_destroy();
+	EXPECT_EQ(result, 0);
+}
+
 // Test case for mm_slab_arena_stats
 TEST_F(SlabArenaTest, SlabArenaStats) {
 	int result = mm_slab_arena_create(config, count);
@@ -132,6 +168,318 @@ TEST_F(SlabArenaTest, SlabArenaStats) {
 	EXPECT_EQ(result, 0);
 }
 
+// Test case for the pointer to pool lookup
+TEST_F(SlabArenaTest, FreeOwner) {
+	struct mm_slab_arena_stats *stats;
+	size_t n;
+	void *small, *large, *heap;
+
+	ASSERT_EQ(mm_slab_arena_create(config, count), 0);
+
+	small = mm_slab_arena_malloc(100);
+	large = mm_slab_arena_malloc(200);
+	heap = mm_slab_arena_malloc(1000);
+	ASSERT_NE(small, nullptr);
+	ASSERT_NE(large, nullptr);
+	ASSERT_NE(heap, nullptr);
+
+	// Inside a pool, but not an element
+	EXPECT_EQ(mm_slab_arena_free((char *)large + 1), -EINVAL);
+
+	EXPECT_EQ(mm_slab_arena_free(heap), 0);
+	EXPECT_EQ(mm_slab_arena_free(large), 0);
+
+	ASSERT_EQ(mm_slab_arena_stats(&stats, &n), 2);
+	EXPECT_EQ(stats[0].inuse, 1);
+	EXPECT_EQ(stats[1].inuse, 0);
+	EXPECT_EQ(stats[1].freed, 1);
+	mm_free(stats);
+
+	// The busy pool is kept, and still owns its buffers
+	EXPECT_EQ(mm_slab_arena_destroy(), -EAGAIN);
+	EXPECT_EQ(mm_slab_arena_free(small), 0);
+	EXPECT_EQ(mm_slab_arena_destroy(), 0);
+}
+
+// Test case for spilling to larger pools
+TEST_F(SlabArenaTest, Spill) {
+	struct mm_slab_arena_stats *stats;
+	void *ptrs[16];
+	size_t n;
+
+	EXPECT_EQ(mm_slab_arena_spill(1), -EINVAL);
+	ASSERT_EQ(mm_slab_arena_create(config, count), 0);
+	EXPECT_EQ(mm_slab_arena_spill(1), 0);
+
+	for (int i = 0; i < 16; i++) {
+		ptrs[i] = mm_slab_arena_malloc(100);
+		ASSERT_NE(ptrs[i], nullptr);
+	}
+
+	ASSERT_EQ(mm_slab_arena_stats(&stats, &n), 2);
+	EXPECT_EQ(stats[0].inuse, 10);
+	EXPECT_EQ(stats[0].spilled, 5);
+	EXPECT_EQ(stats[1].inuse, 5);
+	EXPECT_EQ(stats[1].spilled, 0);
+	mm_free(stats);
+
+	for (int i = 0; i < 16; i++)
+		EXPECT_EQ(mm_slab_arena_free(ptrs[i]), 0);
+
+	// Without spill, the heap takes over right away
+	EXPECT_EQ(mm_slab_arena_spill(0), 0);
+	for (int i = 0; i < 11; i++)
+		ptrs[i] = mm_slab_arena_malloc(100);
+
+	ASSERT_EQ(mm_slab_arena_stats(&stats, &n), 2);
+	EXPECT_EQ(stats[0].inuse, 10);
+	EXPECT_EQ(stats[0].spilled, 5);
+	EXPECT_EQ(stats[1].inuse, 0);
+	mm_free(stats);
+
+	for (int i = 0; i < 11; i++)
+		EXPECT_EQ(mm_slab_arena_free(ptrs[i]), 0);
+
+	EXPECT_EQ(mm_slab_arena_destroy(), 0);
+}
+
+// Test case for independent arenas living next to the default one
+TEST_F(SlabArenaTest, Instances) {
+	struct mm_slab_arena_config other[1] = {};
+	struct mm_slab_arena *arena[2];
+	struct mm_slab_arena_stats *stats;
+	void *ptr[3];
+	size_t n;
+
+	other[0].esize = 512;
+	other[0].ecount = 2;
+
+	ASSERT_EQ(mm_slab_arena_create(config, count), 0);
+	EXPECT_EQ(mm_slab_arena_create(config, count), -EBUSY);
+	ASSERT_EQ(mm_slab_arena_create_r(&arena[0], config, count), 0);
+	ASSERT_EQ(mm_slab_arena_create_r(&arena[1], other, 1), 0);
+
+	ptr[0] = mm_slab_arena_malloc(100);
+	ptr[1] = mm_slab_arena_malloc_r(arena[0], 100);
+	ptr[2] = mm_slab_arena_malloc_r(arena[1], 100);
+	ASSERT_NE(ptr[0], nullptr);
+	ASSERT_NE(ptr[1], nullptr);
+	ASSERT_NE(ptr[2], nullptr);
+
+	// Each arena only accounts for its own allocations
+	ASSERT_EQ(mm_slab_arena_stats_r(arena[1], &stats, &n), 1);
+	EXPECT_EQ(stats[0].esize, 512U);
+	EXPECT_EQ(stats[0].inuse, 1U);
+	mm_free(stats);
+	ASSERT_EQ(mm_slab_arena_stats_r(arena[0], &stats, &n), 2);
+	EXPECT_EQ(stats[0].inuse, 1U);
+	mm_free(stats);
+
+	// A busy arena is not destroyed
+	EXPECT_EQ(mm_slab_arena_destroy_r(arena[1]), -EAGAIN);
+
+	EXPECT_EQ(mm_slab_arena_free(ptr[0]), 0);
+	EXPECT_EQ(mm_slab_arena_free_r(arena[0], ptr[1]), 0);
+	EXPECT_EQ(mm_slab_arena_free_r(arena[1], ptr[2]), 0);
+
+	EXPECT_EQ(mm_slab_arena_destroy_r(arena[1]), 0);
+	EXPECT_EQ(mm_slab_arena_destroy_r(arena[0]), 0);
+	EXPECT_EQ(mm_slab_arena_destroy(), 0);
+	EXPECT_EQ(mm_slab_arena_destroy_r(nullptr), -EINVAL);
+}
+
+// Test case for mm_slab_arena_realloc within a class, across classes and to the heap
+TEST_F(SlabArenaTest, Realloc) {
+	struct mm_slab_arena_stats *stats;
+	uint8_t *ptr, *moved;
+	size_t n;
+
+	ASSERT_EQ(mm_slab_arena_create(config, count), 0);
+
+	ptr = (uint8_t *)mm_slab_arena_realloc(NULL, 100);
+	ASSERT_NE(ptr, nullptr);
+	for (int i = 0; i < 128; i++)
+		ptr[i] = i;
+
+	// Fits the 128-byte element
+	EXPECT_EQ(mm_slab_arena_realloc(ptr, 128), ptr);
+	EXPECT_EQ(mm_slab_arena_realloc(ptr, 10), ptr);
+
+	// Not an element, left untouched
+	EXPECT_EQ(mm_slab_arena_realloc(ptr + 1, 10), nullptr);
+	EXPECT_EQ(mm_slab_arena_realloc(ptr + 1, 200), nullptr);
+	ASSERT_EQ(mm_slab_arena_stats(&stats, &n), 2);
+	EXPECT_EQ(stats[0].inuse, 1U);
+	EXPECT_EQ(stats[1].inuse, 0U);
+	mm_free(stats);
+
+	moved = (uint8_t *)mm_slab_arena_realloc(ptr, 200);
+	ASSERT_NE(moved, nullptr);
+	EXPECT_NE(moved, ptr);
+	for (int i = 0; i < 128; i++)
+		ASSERT_EQ(moved[i], i);
+
+	ASSERT_EQ(mm_slab_arena_stats(&stats, &n), 2);
+	EXPECT_EQ(stats[0].inuse, 0U);
+	EXPECT_EQ(stats[1].inuse, 1U);
+	mm_free(stats);
+
+	// Too large for any pool
+	ptr = (uint8_t *)mm_slab_arena_realloc(moved, 4096);
+	ASSERT_NE(ptr, nullptr);
+	for (int i = 0; i < 128; i++)
+		ASSERT_EQ(ptr[i], i);
+	ptr = (uint8_t *)mm_slab_arena_realloc(ptr, 8192);
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ(ptr[127], 127);
+
+	ASSERT_EQ(mm_slab_arena_stats(&stats, &n), 2);
+	EXPECT_EQ(stats[1].inuse, 0U);
+	mm_free(stats);
+
+	EXPECT_EQ(mm_slab_arena_realloc(ptr, 0), nullptr);
+	EXPECT_EQ(mm_slab_arena_destroy(), 0);
+}
+
+// Test case for a shrinking realloc moving down to a smaller class
+TEST_F(SlabArenaTest, ReallocShrink) {
+	struct mm_slab_arena_stats *stats;
+	uint8_t *ptr, *moved, *full[10];
+	size_t n;
+
+	ASSERT_EQ(mm_slab_arena_create(config, count), 0);
+
+	ptr = (uint8_t *)mm_slab_arena_malloc(200);
+	ASSERT_NE(ptr, nullptr);
+	for (int i = 0; i < 200; i++)
+		ptr[i] = i;
+
+	moved = (uint8_t *)mm_slab_arena_realloc(ptr, 100);
+	ASSERT_NE(moved, nullptr);
+	EXPECT_NE(moved, ptr);
+	for (int i = 0; i < 100; i++)
+		ASSERT_EQ(moved[i], i);
+
+	ASSERT_EQ(mm_slab_arena_stats(&stats, &n), 2);
+	EXPECT_EQ(stats[0].inuse, 1U);
+	EXPECT_EQ(stats[1].inuse, 0U);
+	mm_free(stats);
+
+	// The smaller class is full, the element stays in place
+	for (int i = 0; i < 9; i++) {
+		full[i] = (uint8_t *)mm_slab_arena_malloc(100);
+		ASSERT_NE(full[i], nullptr);
+	}
+	full[9] = moved;
+
+	ptr = (uint8_t *)mm_slab_arena_malloc(200);
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ(mm_slab_arena_realloc(ptr, 100), ptr);
+
+	EXPECT_EQ(mm_slab_arena_free(ptr), 0);
+	for (int i = 0; i < 10; i++)
+		EXPECT_EQ(mm_slab_arena_free(full[i]), 0);
+	EXPECT_EQ(mm_slab_arena_destroy(), 0);
+}
+
+// Test case for the tracked heap usage, back to where it was once destroyed
+TEST_F(SlabArenaTest, Memtrack) {
+	struct mm_malloc_info before, after;
+	struct mm_slab_arena *arena;
+	void *ptr;
+
+	ASSERT_EQ(mm_mt_activate(), 0);
+	before = mm_malloc_info();
+
+	ASSERT_EQ(mm_slab_arena_create_r(&arena, config, count), 0);
+	ptr = mm_slab_arena_malloc_r(arena, 100);
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ(mm_slab_arena_free_r(arena, ptr), 0);
+	EXPECT_EQ(mm_slab_arena_destroy_r(arena), 0);
+
+	after = mm_malloc_info();
+	EXPECT_EQ(after.ucount, before.ucount);
+	EXPECT_EQ(after.uallocated, before.uallocated);
+
+	mm_mt_deactivate();
+}
+
+// Test case for stats filled in a caller buffer and their generation
+TEST_F(SlabArenaTest, Snapshot) {
+	struct mm_slab_arena_stats stats[2];
+	uint64_t gen, before;
+	void *ptr;
+
+	EXPECT_EQ(mm_slab_arena_snapshot(stats, 2, &gen), -EINVAL);
+	EXPECT_EQ(mm_slab_arena_generation(), 0U);
+
+	ASSERT_EQ(mm_slab_arena_create(config, count), 0);
+
+	ASSERT_EQ(mm_slab_arena_snapshot(nullptr, 0, &before), 2);
+	EXPECT_EQ(mm_slab_arena_generation(), before);
+
+	ptr = mm_slab_arena_malloc(200);
+	ASSERT_NE(ptr, nullptr);
+	gen = mm_slab_arena_generation();
+	EXPECT_NE(gen, before);
+
+	// Only the first class fits
+	memset(stats, 0xff, sizeof(stats));
+	ASSERT_EQ(mm_slab_arena_snapshot(stats, 1, &before), 2);
+	EXPECT_EQ(before, gen);
+	EXPECT_EQ(stats[0].esize, 128U);
+	EXPECT_EQ(stats[0].inuse, 0U);
+	EXPECT_EQ(stats[1].esize, SIZE_MAX);
+
+	ASSERT_EQ(mm_slab_arena_snapshot(stats, 2, nullptr), 2);
+	EXPECT_EQ(stats[1].esize, 256U);
+	EXPECT_EQ(stats[1].ecount, 5U);
+	EXPECT_EQ(stats[1].allocated, 1U);
+	EXPECT_EQ(stats[1].inuse, 1U);
+
+	// Unchanged without allocation nor free
+	EXPECT_EQ(mm_slab_arena_generation(), gen);
+
+	EXPECT_EQ(mm_slab_arena_free(ptr), 0);
+	EXPECT_NE(mm_slab_arena_generation(), gen);
+
+	EXPECT_EQ(mm_slab_arena_destroy(), 0);
+}
+
+// Test case for the size to pool lookup, on both sides of each class boundary
+TEST(SlabArenaClassTest, Lookup) {
+	struct mm_slab_arena_config config[7] = {};
+	const size_t esize[7] = { 32, 96, 1024, 1056, 1536, 5000, 65536 };
+	struct mm_slab_arena_stats *stats;
+	size_t count, size;
+
+	for (int i = 0; i < 7; i++) {
+		config[i].esize = esize[i];
+		config[i].ecount = 1;
+	}
+	ASSERT_EQ(mm_slab_arena_create(config, 7), 0);
+
+	for (size = 1; size <= 70000; size++) {
+		void *ptr = mm_slab_arena_malloc(size);
+		size_t expected = 0;
+
+		ASSERT_NE(ptr, nullptr);
+
+		// Element sizes are rounded up to MM_ALIGN
+		while (expected < 7 && size > ROUNDUP(esize[expected], MM_ALIGN))
+			expected++;
+
+		ASSERT_EQ(mm_slab_arena_stats(&stats, &count), 7);
+		for (size_t i = 0; i < 7; i++)
+			ASSERT_EQ(stats[i].inuse, i == expected ? 1 : 0) << "size " << size;
+		mm_free(stats);
+
+		EXPECT_EQ(mm_slab_arena_free(ptr), 0);
+	}
+
+	EXPECT_EQ(mm_slab_arena_destroy(), 0);
+}
+
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();
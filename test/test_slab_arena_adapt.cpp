@@ -0,0 +1,161 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <mm/alloc.h>
+#include <mm/slab_arena.h>
+
+// Test fixture for adaptive slab arenas
+class SlabArenaAdaptTest : public ::testing::Test {
+protected:
+	struct mm_slab_arena_config config[2] = {};
+	struct mm_slab_arena *arena = nullptr;
+
+	void SetUp() override {
+		config[0].esize = 64;
+		config[0].ecount = 4;
+		config[1].esize = 256;
+		config[1].ecount = 4;
+
+		ASSERT_EQ(mm_slab_arena_create_r(&arena, config, 2), 0);
+	}
+
+	void TearDown() override {
+		EXPECT_EQ(mm_slab_arena_destroy_r(arena), 0);
+	}
+
+	size_t ecount(size_t cls) {
+		struct mm_slab_arena_config *c;
+		size_t count, n;
+
+		if (mm_slab_arena_get_config_r(arena, &c, &count) != 2)
+			return 0;
+
+		n = c[cls].ecount;
+		mm_free(c);
+
+		return n;
+	}
+};
+
+// Test case for a hot class growing then shrinking back once cold
+TEST_F(SlabArenaAdaptTest, GrowAndShrink) {
+	struct mm_slab_arena_stats *stats;
+	void *ptr[14];
+	size_t count;
+
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 0), -EINVAL);
+
+	// Nothing missed, nothing to do
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 1 << 20), 0);
+
+	// 6 allocations fall back to the heap
+	for (int i = 0; i < 10; i++) {
+		ptr[i] = mm_slab_arena_malloc_r(arena, 60);
+		ASSERT_NE(ptr[i], nullptr);
+	}
+
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 1 << 20), 1);
+	EXPECT_EQ(ecount(0), 8U);
+	EXPECT_EQ(ecount(1), 4U);
+
+	// The new pool serves the class
+	for (int i = 10; i < 14; i++) {
+		ptr[i] = mm_slab_arena_malloc_r(arena, 60);
+		ASSERT_NE(ptr[i], nullptr);
+	}
+	ASSERT_EQ(mm_slab_arena_stats_r(arena, &stats, &count), 2);
+	EXPECT_EQ(stats[0].ecount, 8U);
+	EXPECT_EQ(stats[0].inuse, 8U);
+	mm_free(stats);
+
+	// Busy classes are not shrunk
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 1 << 20), 0);
+
+	for (int i = 0; i < 14; i++)
+		EXPECT_EQ(mm_slab_arena_free_r(arena, ptr[i]), 0);
+
+	ASSERT_EQ(mm_slab_arena_stats_r(arena, &stats, &count), 2);
+	EXPECT_EQ(stats[0].inuse, 0U);
+	mm_free(stats);
+
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 1 << 20), 1);
+	EXPECT_EQ(ecount(0), 4U);
+
+	// The configured pool is kept
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 1 << 20), 0);
+	EXPECT_EQ(ecount(0), 4U);
+}
+
+// Test case for the growth within the memory budget
+TEST_F(SlabArenaAdaptTest, Budget) {
+	const size_t budget = 4 * 64 + 4 * 256 + 2 * 64;
+	void *ptr[6];
+
+	for (int i = 0; i < 6; i++)
+		ptr[i] = mm_slab_arena_malloc_r(arena, 64);
+
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, budget), 1);
+	EXPECT_EQ(ecount(0), 6U);
+
+	// The budget is spent
+	EXPECT_EQ(mm_slab_arena_free_r(arena, mm_slab_arena_malloc_r(arena, 64)), 0);
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, budget), 0);
+
+	for (int i = 0; i < 6; i++)
+		EXPECT_EQ(mm_slab_arena_free_r(arena, ptr[i]), 0);
+}
+
+// Test case for the generation and the totals kept across grow and shrink
+TEST_F(SlabArenaAdaptTest, Generation) {
+	struct mm_slab_arena_stats before[2], after[2];
+	uint64_t gen, next;
+	void *ptr[10];
+
+	for (int i = 0; i < 10; i++) {
+		ptr[i] = mm_slab_arena_malloc_r(arena, 60);
+		ASSERT_NE(ptr[i], nullptr);
+	}
+
+	gen = mm_slab_arena_generation_r(arena);
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 1 << 20), 1);
+	next = mm_slab_arena_generation_r(arena);
+	EXPECT_GT(next, gen);
+	gen = next;
+
+	// Buffers of the new pool, counted in its own counters
+	for (int i = 4; i < 8; i++) {
+		EXPECT_EQ(mm_slab_arena_free_r(arena, ptr[i]), 0);
+		ptr[i] = mm_slab_arena_malloc_r(arena, 60);
+		ASSERT_NE(ptr[i], nullptr);
+	}
+	next = mm_slab_arena_generation_r(arena);
+	EXPECT_GT(next, gen);
+	gen = next;
+
+	for (int i = 0; i < 10; i++)
+		EXPECT_EQ(mm_slab_arena_free_r(arena, ptr[i]), 0);
+	next = mm_slab_arena_generation_r(arena);
+	EXPECT_GT(next, gen);
+	gen = next;
+
+	ASSERT_EQ(mm_slab_arena_snapshot_r(arena, before, 2, NULL), 2);
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 1 << 20), 1);
+	EXPECT_EQ(ecount(0), 4U);
+	ASSERT_EQ(mm_slab_arena_snapshot_r(arena, after, 2, &next), 2);
+	EXPECT_GT(next, gen);
+
+	// The retired pool still counts in the totals of its class
+	EXPECT_EQ(after[0].allocated, before[0].allocated);
+	EXPECT_EQ(after[0].missed, before[0].missed);
+	EXPECT_EQ(after[0].freed, before[0].freed);
+	EXPECT_EQ(after[0].hwm, before[0].hwm);
+	EXPECT_EQ(after[0].inuse, 0U);
+	EXPECT_EQ(after[0].ecount, 4U);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,45 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+// Built with its own copy of the library, with MM_ALIGN set to 4
+
+#include <gtest/gtest.h>
+
+#include <mm/alloc.h>
+#include <mm/config/config.h>
+#include <mm/slab_arena.h>
+
+static_assert(MM_ALIGN == 4, "this test needs an element alignment below 8");
+
+// Test case for element sizes that are not a multiple of the lookup granularity
+TEST(SlabArenaAlignTest, Lookup) {
+	struct mm_slab_arena_config config[2] = {};
+	struct mm_slab_arena_stats stats[2];
+	struct mm_slab_arena *arena;
+
+	config[0].esize = 20;
+	config[0].ecount = 1;
+	config[1].esize = 64;
+	config[1].ecount = 1;
+	ASSERT_EQ(mm_slab_arena_create_r(&arena, config, 2), 0);
+
+	for (size_t size = 1; size <= 64; size++) {
+		void *ptr = mm_slab_arena_malloc_r(arena, size);
+		size_t expected = size <= 20 ? 0 : 1;
+
+		ASSERT_NE(ptr, nullptr);
+		ASSERT_EQ(mm_slab_arena_snapshot_r(arena, stats, 2, nullptr), 2);
+		EXPECT_EQ(stats[0].esize, 20U);
+		for (size_t i = 0; i < 2; i++)
+			ASSERT_EQ(stats[i].inuse, i == expected ? 1U : 0U) << "size " << size;
+
+		EXPECT_EQ(mm_slab_arena_free_r(arena, ptr), 0);
+	}
+
+	EXPECT_EQ(mm_slab_arena_destroy_r(arena), 0);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,104 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <mm/alloc.h>
+#include <mm/config/config.h>
+#include <mm/slab_arena.h>
+
+// Test case for the class boundaries losing the least memory
+TEST(SlabArenaPlanTest, Classes) {
+	struct mm_slab_arena_size hist[3] = {
+		{ 3 * MM_ALIGN, 1000 },
+		{ 1 * MM_ALIGN, 1000 },
+		{ 2 * MM_ALIGN, 1 },
+	};
+	struct mm_slab_arena_config *config;
+	size_t count;
+
+	ASSERT_EQ(mm_slab_arena_plan(hist, 3, 1 << 20, 0.0, 2, &config, &count), 2);
+	ASSERT_EQ(count, 2U);
+	EXPECT_EQ(config[0].esize, 1U * MM_ALIGN);
+	EXPECT_EQ(config[0].ecount, 1000U);
+	EXPECT_EQ(config[1].esize, 3U * MM_ALIGN);
+	EXPECT_EQ(config[1].ecount, 1001U);
+	mm_free(config);
+
+	ASSERT_EQ(mm_slab_arena_plan(hist, 3, 1 << 20, 0.0, 8, &config, &count), 3);
+	mm_free(config);
+
+	ASSERT_EQ(mm_slab_arena_plan(hist, 3, 1 << 20, 0.0, 1, &config, &count), 1);
+	EXPECT_EQ(config[0].esize, 3U * MM_ALIGN);
+	EXPECT_EQ(config[0].ecount, 2001U);
+	mm_free(config);
+}
+
+// Test case for sizes sharing an element size once aligned
+TEST(SlabArenaPlanTest, Alignment) {
+	struct mm_slab_arena_size hist[2] = {
+		{ MM_ALIGN - 8, 10 },
+		{ MM_ALIGN, 10 },
+	};
+	struct mm_slab_arena_config *config;
+	size_t count;
+
+	ASSERT_EQ(mm_slab_arena_plan(hist, 2, 1 << 20, 0.0, 4, &config, &count), 1);
+	EXPECT_EQ(config[0].esize, (size_t)MM_ALIGN);
+	EXPECT_EQ(config[0].ecount, 20U);
+	mm_free(config);
+}
+
+// Test case for the largest objects left to the heap to fit the budget
+TEST(SlabArenaPlanTest, Budget) {
+	struct mm_slab_arena_size hist[2] = {
+		{ MM_ALIGN, 200 },
+		{ 4 * MM_ALIGN, 20 },
+	};
+	const size_t budget = 200 * MM_ALIGN + 10 * 4 * MM_ALIGN;
+	struct mm_slab_arena_config *config;
+	size_t count;
+
+	ASSERT_EQ(mm_slab_arena_plan(hist, 2, budget, 0.05, 4, &config, &count), 2);
+	EXPECT_EQ(config[0].ecount, 200U);
+	EXPECT_EQ(config[1].esize, 4U * MM_ALIGN);
+	EXPECT_EQ(config[1].ecount, 10U);
+	mm_free(config);
+
+	// 10 objects out of 220 is more than 1%
+	EXPECT_EQ(mm_slab_arena_plan(hist, 2, budget, 0.01, 4, &config, &count), -ENOSPC);
+
+	EXPECT_EQ(mm_slab_arena_plan(hist, 2, 0, 0.01, 4, &config, &count), -EINVAL);
+	EXPECT_EQ(mm_slab_arena_plan(hist, 2, budget, 0.01, 0, &config, &count), -EINVAL);
+	EXPECT_EQ(mm_slab_arena_plan(nullptr, 2, budget, 0.01, 4, &config, &count), -EINVAL);
+}
+
+// Test case for a histogram of many sizes, merged before the search
+TEST(SlabArenaPlanTest, ManySizes) {
+	const size_t n = 16384;
+	struct mm_slab_arena_size *hist;
+	struct mm_slab_arena_config *config;
+	size_t count, total = 0;
+
+	hist = (struct mm_slab_arena_size *)mm_calloc(n, sizeof(*hist));
+	ASSERT_NE(hist, nullptr);
+	for (size_t i = 0; i < n; i++) {
+		hist[i].size = (i + 1) * MM_ALIGN;
+		hist[i].count = 1;
+	}
+
+	ASSERT_GT(mm_slab_arena_plan(hist, n, SIZE_MAX, 0.0, 8, &config, &count), 0);
+	EXPECT_LE(count, 8U);
+	EXPECT_EQ(config[count - 1].esize, n * MM_ALIGN);
+	for (size_t i = 0; i < count; i++)
+		total += config[i].ecount;
+	EXPECT_EQ(total, n);
+
+	mm_free(config);
+	mm_free(hist);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
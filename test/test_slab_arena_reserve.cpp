@@ -0,0 +1,119 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <cstdint>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include <mm/alloc.h>
+#include <mm/page.h>
+#include <mm/slab_arena.h>
+
+#define SPAN (1u << 20)
+
+// Test fixture for slab arenas in a single reservation
+class SlabArenaReserveTest : public ::testing::Test {
+protected:
+	struct mm_slab_arena_config config[3] = {};
+	struct mm_slab_arena *arena = nullptr;
+
+	void SetUp() override {
+		config[0].esize = 64;
+		config[0].ecount = 16;
+		config[1].esize = 256;
+		config[1].ecount = 16;
+		config[2].esize = 4096;
+		config[2].ecount = 4;
+
+		ASSERT_EQ(mm_slab_arena_create_reserved_r(&arena, config, 3, SPAN - 1), 0);
+	}
+
+	void TearDown() override {
+		EXPECT_EQ(mm_slab_arena_destroy_r(arena), 0);
+	}
+};
+
+// Test case for the pools laid out at the offset of their class
+TEST_F(SlabArenaReserveTest, Layout) {
+	uintptr_t p[3];
+	void *heap;
+
+	p[0] = (uintptr_t)mm_slab_arena_malloc_r(arena, 60);
+	p[1] = (uintptr_t)mm_slab_arena_malloc_r(arena, 200);
+	p[2] = (uintptr_t)mm_slab_arena_malloc_r(arena, 4000);
+	ASSERT_NE(p[0], 0U);
+	ASSERT_NE(p[1], 0U);
+	ASSERT_NE(p[2], 0U);
+
+	// One span of SPAN bytes per class, starting with the first class
+	EXPECT_EQ(p[1] / SPAN - p[0] / SPAN, 1U);
+	EXPECT_EQ(p[2] / SPAN - p[0] / SPAN, 2U);
+
+	heap = mm_slab_arena_malloc_r(arena, 8192);
+	ASSERT_NE(heap, nullptr);
+	EXPECT_EQ(mm_slab_arena_free_r(arena, heap), 0);
+
+	for (int i = 0; i < 3; i++)
+		EXPECT_EQ(mm_slab_arena_free_r(arena, (void *)p[i]), 0);
+
+	// A pointer inside the reservation but out of any pool
+	EXPECT_NE(mm_slab_arena_free_r(arena, (void *)(p[0] + 1)), 0);
+}
+
+// Test case for pools committed and decommitted in a class span
+TEST_F(SlabArenaReserveTest, Adapt) {
+	struct mm_slab_arena_stats *stats;
+	void *ptr[40];
+	size_t count;
+
+	for (int i = 0; i < 40; i++)
+		ptr[i] = mm_slab_arena_malloc_r(arena, 60);
+
+	// 16 more elements committed after the first pool
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 1 << 20), 1);
+	for (int i = 0; i < 40; i++)
+		EXPECT_EQ(mm_slab_arena_free_r(arena, ptr[i]), 0);
+
+	for (int i = 0; i < 32; i++) {
+		ptr[i] = mm_slab_arena_malloc_r(arena, 60);
+		ASSERT_NE(ptr[i], nullptr);
+		memset(ptr[i], 0xa5, 60);
+	}
+	ASSERT_EQ(mm_slab_arena_stats_r(arena, &stats, &count), 3);
+	EXPECT_EQ(stats[0].inuse, 32U);
+	mm_free(stats);
+
+	for (int i = 0; i < 32; i++)
+		EXPECT_EQ(mm_slab_arena_free_r(arena, ptr[i]), 0);
+
+	// The retired pool goes back to the span
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 1 << 20), 1);
+	EXPECT_EQ(mm_slab_arena_adapt_r(arena, 1 << 20), 0);
+}
+
+// Test case for classes too large for their span
+TEST(SlabArenaReserveSpanTest, TooSmall) {
+	struct mm_slab_arena_config config[1] = {};
+	struct mm_slab_arena_stats *stats;
+	struct mm_slab_arena *arena;
+	size_t count;
+
+	config[0].esize = 4096;
+	config[0].ecount = 64;
+
+	EXPECT_EQ(mm_slab_arena_create_reserved_r(&arena, config, 1, 0), -EINVAL);
+
+	// The pool is not created, allocations fall back to the heap
+	ASSERT_EQ(mm_slab_arena_create_reserved_r(&arena, config, 1, 64 * 1024), 0);
+	EXPECT_LT(mm_slab_arena_stats_r(arena, &stats, &count), 0);
+	void *ptr = mm_slab_arena_malloc_r(arena, 4096);
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ(mm_slab_arena_free_r(arena, ptr), 0);
+	EXPECT_EQ(mm_slab_arena_destroy_r(arena), 0);
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,178 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <future>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <mm/alloc.h>
+#include <mm/slab_arena.h>
+
+// Test fixture for the thread caches of slab arenas
+class SlabArenaTcacheTest : public ::testing::Test {
+protected:
+	struct mm_slab_arena_config config[2] = {};
+	struct mm_slab_arena *arena = nullptr;
+
+	void SetUp() override {
+		config[0].esize = 128;
+		config[0].ecount = 64;
+		config[1].esize = 256;
+		config[1].ecount = 64;
+
+		ASSERT_EQ(mm_slab_arena_create_r(&arena, config, 2), 0);
+		ASSERT_EQ(mm_slab_arena_tcache_r(arena, 8), 0);
+	}
+
+	void TearDown() override {
+		if (arena) {
+			EXPECT_EQ(mm_slab_arena_destroy_r(arena), 0);
+		}
+	}
+
+	size_t inuse(size_t pool) {
+		struct mm_slab_arena_stats *stats;
+		size_t count, n;
+
+		if (mm_slab_arena_stats_r(arena, &stats, &count) < 0)
+			return SIZE_MAX;
+
+		n = stats[pool].inuse;
+		mm_free(stats);
+
+		return n;
+	}
+
+	static int count_cb(void *obj, void *ctx) {
+		(void)obj;
+		(*(size_t *)ctx)++;
+		return 0;
+	}
+
+	size_t visited() {
+		size_t n = 0;
+
+		if (mm_slab_arena_foreach_r(arena, count_cb, &n) != 0)
+			return SIZE_MAX;
+
+		return n;
+	}
+};
+
+// Test case for refills and flushes by half a cache
+TEST_F(SlabArenaTcacheTest, RefillAndFlush) {
+	void *ptr[20];
+
+	EXPECT_EQ(mm_slab_arena_tcache_r(arena, 8), -EBUSY);
+
+	ptr[0] = mm_slab_arena_malloc_r(arena, 100);
+	ASSERT_NE(ptr[0], nullptr);
+	EXPECT_EQ(inuse(0), 4U);
+	EXPECT_EQ(inuse(1), 0U);
+
+	// The element stays cached
+	EXPECT_EQ(mm_slab_arena_free_r(arena, ptr[0]), 0);
+	EXPECT_EQ(inuse(0), 4U);
+	EXPECT_EQ(mm_slab_arena_malloc_r(arena, 100), ptr[0]);
+	EXPECT_EQ(mm_slab_arena_free_r(arena, ptr[0]), 0);
+
+	for (int i = 0; i < 20; i++) {
+		ptr[i] = mm_slab_arena_malloc_r(arena, 200);
+		ASSERT_NE(ptr[i], nullptr);
+	}
+	EXPECT_EQ(inuse(1), 20U);
+
+	// A full cache gives half of it back
+	for (int i = 0; i < 20; i++)
+		EXPECT_EQ(mm_slab_arena_free_r(arena, ptr[i]), 0);
+	EXPECT_LE(inuse(1), 8U);
+
+	EXPECT_EQ(mm_slab_arena_tcache_flush_r(arena), 0);
+	EXPECT_EQ(inuse(0), 0U);
+	EXPECT_EQ(inuse(1), 0U);
+}
+
+// Test case for the flush of the cache of an exiting thread
+TEST_F(SlabArenaTcacheTest, ThreadExit) {
+	std::thread t([this]() {
+		void *ptr[10];
+
+		for (int i = 0; i < 10; i++)
+			ptr[i] = mm_slab_arena_malloc_r(arena, 64);
+		for (int i = 0; i < 10; i++)
+			mm_slab_arena_free_r(arena, ptr[i]);
+	});
+
+	t.join();
+
+	EXPECT_EQ(inuse(0), 0U);
+}
+
+#if defined(DEBUG)
+// Test case for a double free, not cached twice in debug builds
+TEST_F(SlabArenaTcacheTest, DoubleFree) {
+	void *ptr = mm_slab_arena_malloc_r(arena, 100);
+	void *a, *b;
+
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ(mm_slab_arena_free_r(arena, ptr), 0);
+	EXPECT_EQ(mm_slab_arena_free_r(arena, ptr), 0);
+
+	a = mm_slab_arena_malloc_r(arena, 100);
+	b = mm_slab_arena_malloc_r(arena, 100);
+	ASSERT_NE(a, nullptr);
+	ASSERT_NE(b, nullptr);
+	EXPECT_NE(a, b);
+	EXPECT_EQ(mm_slab_arena_free_r(arena, a), 0);
+	EXPECT_EQ(mm_slab_arena_free_r(arena, b), 0);
+
+	// Free in its pool once flushed
+	EXPECT_EQ(mm_slab_arena_tcache_flush_r(arena), 0);
+	EXPECT_EQ(mm_slab_arena_free_r(arena, ptr), 0);
+	EXPECT_EQ(inuse(0), 0U);
+}
+#endif /* DEBUG */
+
+// Test case for the elements cached by another thread, not visited
+TEST_F(SlabArenaTcacheTest, ForeachSkipsCached) {
+	std::promise<void> cached, done;
+	void *live = nullptr;
+	std::thread t([&]() {
+		void *ptr = mm_slab_arena_malloc_r(arena, 100);
+
+		live = mm_slab_arena_malloc_r(arena, 100);
+		mm_slab_arena_free_r(arena, ptr);
+		cached.set_value();
+		done.get_future().wait();
+	});
+
+	cached.get_future().wait();
+	ASSERT_NE(live, nullptr);
+	EXPECT_EQ(inuse(0), 4U);
+	EXPECT_EQ(visited(), 1U);
+
+	done.set_value();
+	t.join();
+
+	EXPECT_EQ(mm_slab_arena_free_r(arena, live), 0);
+	EXPECT_EQ(mm_slab_arena_tcache_flush_r(arena), 0);
+	EXPECT_EQ(visited(), 0U);
+}
+
+// Test case for the flush of every cache at destroy
+TEST_F(SlabArenaTcacheTest, Destroy) {
+	void *ptr = mm_slab_arena_malloc_r(arena, 100);
+
+	ASSERT_NE(ptr, nullptr);
+	EXPECT_EQ(mm_slab_arena_free_r(arena, ptr), 0);
+	EXPECT_GT(inuse(0), 0U);
+
+	EXPECT_EQ(mm_slab_arena_destroy_r(arena), 0);
+	arena = nullptr;
+}
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
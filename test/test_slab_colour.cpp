@@ -0,0 +1,114 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <mm/config/config.h>
+#include <mm/slab.h>
+
+static uint8_t _buffers[2][8 * 128 + MM_COLOUR_SPAN] __attribute__((aligned(MM_COLOUR_SPAN)));
+static uint8_t _large[4 * (4096 + MM_CACHELINE_SIZE)] __attribute__((aligned(MM_COLOUR_SPAN)));
+
+// Successive coloured pools start at different cache-line offsets
+TEST(SlabColourTest, PoolOffsets)
+{
+	struct mm_slab_config config = {};
+	uintptr_t offsets[2];
+
+	config.esize = 128;
+	config.ecount = 8;
+	config.size = sizeof(_buffers[0]);
+	config.flags = MM_SLAB_F_COLOUR;
+
+	struct mm_slab *slabs[2];
+	for (int i = 0; i < 2; i++) {
+		config.buffer = _buffers[i];
+		slabs[i] = mm_slab_create_config(&config);
+		ASSERT_NE(slabs[i], nullptr);
+
+		void *ptr = mm_slab_alloc(slabs[i]);
+		ASSERT_NE(ptr, nullptr);
+		offsets[i] = (uintptr_t)ptr - (uintptr_t)_buffers[i];
+		EXPECT_EQ(offsets[i] % MM_CACHELINE_SIZE, 0);
+		EXPECT_LE(offsets[i] + 8 * 128, sizeof(_buffers[i]));
+		EXPECT_EQ(mm_slab_free(slabs[i], ptr), 0);
+	}
+
+	EXPECT_EQ((offsets[0] + MM_CACHELINE_SIZE) % MM_COLOUR_SPAN, offsets[1]);
+
+	for (int i = 0; i < 2; i++)
+		EXPECT_EQ(mm_slab_destroy(slabs[i]), 0);
+}
+
+// Without tail space, a coloured pool in a user buffer is left untouched
+TEST(SlabColourTest, NoRoom)
+{
+	uint8_t buffer[8 * 128];
+	struct mm_slab_config config = {};
+
+	config.buffer = buffer;
+	config.size = sizeof(buffer);
+	config.esize = 128;
+	config.ecount = 8;
+	config.flags = MM_SLAB_F_COLOUR;
+
+	struct mm_slab *slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+	EXPECT_EQ(mm_slab_alloc(slab), (void *)buffer);
+	EXPECT_EQ(mm_slab_free(slab, buffer), 0);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
+// Elements whose size is a multiple of the colour span are spread over cache sets
+TEST(SlabColourTest, LargeElements)
+{
+	struct mm_slab_config config = {};
+	void *ptrs[4];
+
+	config.buffer = _large;
+	config.size = sizeof(_large);
+	config.esize = 4096;
+	config.ecount = 4;
+	config.flags = MM_SLAB_F_COLOUR;
+
+	struct mm_slab *slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+
+	EXPECT_EQ(mm_slab_alloc_bulk(slab, ptrs, 4), 4);
+	for (int i = 0; i < 4; i++) {
+		EXPECT_GE((uintptr_t)ptrs[i], (uintptr_t)_large);
+		EXPECT_LE((uintptr_t)ptrs[i] + 4096, (uintptr_t)_large + sizeof(_large));
+	}
+
+	for (int i = 1; i < 4; i++)
+		EXPECT_EQ((uintptr_t)ptrs[i] - (uintptr_t)ptrs[i - 1], 4096 + MM_CACHELINE_SIZE);
+
+	size_t esize;
+	EXPECT_EQ(mm_slab_stats(slab, &esize, nullptr, nullptr, nullptr, nullptr), 0);
+	EXPECT_EQ(esize, 4096);
+
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 4), 0);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+
+	// Allocated pools are coloured the same way
+	config.buffer = nullptr;
+	config.size = 0;
+	config.alignment = 16;
+	slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+
+	EXPECT_EQ(mm_slab_alloc_bulk(slab, ptrs, 4), 4);
+	for (int i = 0; i < 4; i++)
+		EXPECT_EQ((uintptr_t)ptrs[i] % 16, 0);
+	EXPECT_EQ((uintptr_t)ptrs[1] - (uintptr_t)ptrs[0], 4096 + MM_CACHELINE_SIZE);
+	memset(ptrs[3], 0xa5, 4096);
+
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 4), 0);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
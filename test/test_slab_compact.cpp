@@ -0,0 +1,159 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include <mm/page.h>
+#include <mm/slab.h>
+
+#define ESIZE 256
+#define ECOUNT 1024
+
+struct object {
+	int id;
+	int pinned;
+	uint8_t payload[ESIZE - 2 * sizeof(int)];
+};
+
+// The owner keeps a table of references to its objects
+struct owner {
+	struct object *table[ECOUNT];
+	int relocations;
+};
+
+static int relocate_cb(void *dst, void *src, void *ctx)
+{
+	struct owner *owner = (struct owner *)ctx;
+	struct object *obj = (struct object *)src;
+
+	if (obj->pinned)
+		return -EBUSY;
+
+	memcpy(dst, src, sizeof(struct object));
+	owner->table[obj->id] = (struct object *)dst;
+	owner->relocations++;
+
+	return 0;
+}
+
+class SlabCompactTest : public ::testing::Test {
+    protected:
+	struct owner owner = {};
+	struct mm_slab *slab = nullptr;
+
+	void SetUp() override
+	{
+		struct mm_slab_config config = {};
+
+		config.esize = ESIZE;
+		config.ecount = ECOUNT;
+		config.flags = MM_SLAB_F_PAGES;
+		config.relocate = relocate_cb;
+		config.ctx = &owner;
+
+		slab = mm_slab_create_config(&config);
+		ASSERT_NE(slab, nullptr);
+
+		// Fill the pool, then keep one object out of 64
+		for (int i = 0; i < ECOUNT; i++) {
+			owner.table[i] = (struct object *)mm_slab_alloc(slab);
+			ASSERT_NE(owner.table[i], nullptr);
+			owner.table[i]->id = i;
+			owner.table[i]->pinned = 0;
+			memset(owner.table[i]->payload, i & 0xff, sizeof(owner.table[i]->payload));
+		}
+
+		for (int i = 0; i < ECOUNT; i++) {
+			if (i % 64 == 63)
+				continue;
+			EXPECT_EQ(mm_slab_free(slab, owner.table[i]), 0);
+			owner.table[i] = nullptr;
+		}
+	}
+
+	void TearDown() override
+	{
+		for (int i = 0; i < ECOUNT; i++) {
+			if (owner.table[i]) {
+				EXPECT_EQ(mm_slab_free(slab, owner.table[i]), 0);
+			}
+		}
+
+		EXPECT_EQ(mm_slab_destroy(slab), 0);
+	}
+
+	void check()
+	{
+		for (int i = 0; i < ECOUNT; i++) {
+			if (!owner.table[i])
+				continue;
+			EXPECT_EQ(owner.table[i]->id, i);
+			EXPECT_EQ(owner.table[i]->payload[0], i & 0xff);
+			EXPECT_EQ(owner.table[i]->payload[sizeof(owner.table[i]->payload) - 1], i & 0xff);
+		}
+	}
+};
+
+TEST_F(SlabCompactTest, PackAndRelease)
+{
+	size_t moved, released;
+
+	EXPECT_EQ(mm_slab_compact(slab, &moved, &released), 0);
+	EXPECT_EQ(moved, 16);
+	EXPECT_EQ(owner.relocations, 16);
+	check();
+
+	// The 16 live objects now use the first page only
+	uintptr_t first = UINTPTR_MAX, last = 0;
+	for (int i = 0; i < ECOUNT; i++) {
+		if (!owner.table[i])
+			continue;
+		first = std::min(first, (uintptr_t)owner.table[i]);
+		last = std::max(last, (uintptr_t)owner.table[i]);
+	}
+	EXPECT_EQ(last - first, 15 * ESIZE);
+	EXPECT_GE(released, (size_t)ECOUNT * ESIZE - 2 * mm_page_size());
+
+	// Nothing left to move, the released pages can be used again
+	EXPECT_EQ(mm_slab_compact(slab, &moved, nullptr), 0);
+	EXPECT_EQ(moved, 0);
+
+	void *ptrs[ECOUNT - 16];
+	ASSERT_EQ(mm_slab_alloc_bulk(slab, ptrs, ECOUNT - 16), ECOUNT - 16);
+	for (auto ptr : ptrs)
+		memset(ptr, 0xff, ESIZE);
+	check();
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, ECOUNT - 16), 0);
+}
+
+TEST_F(SlabCompactTest, Pinned)
+{
+	size_t moved;
+
+	// The last object refuses to move, the others move below it
+	owner.table[ECOUNT - 1]->pinned = 1;
+
+	EXPECT_EQ(mm_slab_compact(slab, &moved, nullptr), 0);
+	EXPECT_EQ(moved, 15);
+	check();
+	EXPECT_EQ(owner.table[ECOUNT - 1]->pinned, 1);
+}
+
+TEST(SlabCompactInvalidTest, Invalid)
+{
+	struct mm_slab *slab = mm_slab_create(nullptr, 0, 64, 64);
+	ASSERT_NE(slab, nullptr);
+
+	EXPECT_EQ(mm_slab_compact(nullptr, nullptr, nullptr), -EINVAL);
+	EXPECT_EQ(mm_slab_compact(slab, nullptr, nullptr), -ENOTSUP);
+
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
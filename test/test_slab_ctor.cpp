@@ -0,0 +1,132 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <mm/slab.h>
+
+struct object {
+	uint32_t magic;
+	int generation;
+};
+
+struct counters {
+	int constructed;
+	int destructed;
+	int fail_at;
+};
+
+static int object_ctor(void *obj, void *ctx)
+{
+	struct object *o = (struct object *)obj;
+	struct counters *c = (struct counters *)ctx;
+
+	if (c->fail_at >= 0 && c->constructed == c->fail_at)
+		return -ENOMEM;
+
+	o->magic = 0xcafe;
+	o->generation = 0;
+	c->constructed++;
+
+	return 0;
+}
+
+static void object_dtor(void *obj, void *ctx)
+{
+	struct object *o = (struct object *)obj;
+	struct counters *c = (struct counters *)ctx;
+
+	EXPECT_EQ(o->magic, 0xcafe);
+	o->magic = 0;
+	c->destructed++;
+}
+
+// Test fixture for slab object caches
+class SlabCtorTest : public ::testing::Test {
+    protected:
+	struct counters counters = { 0, 0, -1 };
+	struct mm_slab_config config = {};
+
+	void SetUp() override
+	{
+		config.alignment = 16;
+		config.esize = sizeof(struct object);
+		config.ecount = 8;
+		config.ctor = object_ctor;
+		config.dtor = object_dtor;
+		config.ctx = &counters;
+	}
+};
+
+// Objects are constructed once at creation and destructed once at destruction
+TEST_F(SlabCtorTest, ConstructOnce)
+{
+	struct mm_slab *slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+	EXPECT_EQ(counters.constructed, 8);
+
+	for (int round = 0; round < 4; round++) {
+		struct object *objs[8];
+
+		for (int i = 0; i < 8; i++) {
+			objs[i] = (struct object *)mm_slab_alloc(slab);
+			ASSERT_NE(objs[i], nullptr);
+			EXPECT_EQ(objs[i]->magic, 0xcafe);
+			objs[i]->generation++;
+		}
+
+		for (int i = 0; i < 8; i++)
+			EXPECT_EQ(mm_slab_free(slab, objs[i]), 0);
+	}
+
+	EXPECT_EQ(counters.constructed, 8);
+	EXPECT_EQ(counters.destructed, 0);
+
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+	EXPECT_EQ(counters.destructed, 8);
+}
+
+// A failing constructor rolls back the already constructed objects
+TEST_F(SlabCtorTest, ConstructorFailure)
+{
+	counters.fail_at = 5;
+
+	struct mm_slab *slab = mm_slab_create_config(&config);
+	EXPECT_EQ(slab, nullptr);
+	EXPECT_EQ(counters.constructed, 5);
+	EXPECT_EQ(counters.destructed, 5);
+}
+
+// Objects living in a user buffer are constructed in place
+TEST_F(SlabCtorTest, StaticBuffer)
+{
+	struct object buffer[8];
+
+	config.alignment = 0;
+	config.buffer = buffer;
+
+	struct mm_slab *slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+
+	for (int i = 0; i < 8; i++)
+		EXPECT_EQ(buffer[i].magic, 0xcafe);
+
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+	for (int i = 0; i < 8; i++)
+		EXPECT_EQ(buffer[i].magic, 0);
+}
+
+TEST_F(SlabCtorTest, Invalid)
+{
+	EXPECT_EQ(mm_slab_create_config(nullptr), nullptr);
+
+	config.ecount = 0;
+	EXPECT_EQ(mm_slab_create_config(&config), nullptr);
+	EXPECT_EQ(counters.constructed, 0);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
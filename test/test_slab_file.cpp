@@ -0,0 +1,153 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <mm/slab.h>
+
+struct node {
+	uint64_t value;
+	ssize_t next;
+};
+
+static int node_ctor(void *obj, void *ctx)
+{
+	struct node *n = (struct node *)obj;
+	int *constructed = (int *)ctx;
+
+	n->value = 0;
+	n->next = -1;
+	(*constructed)++;
+
+	return 0;
+}
+
+static int node_count(void *obj, void *ctx)
+{
+	(void)obj;
+	(*(size_t *)ctx)++;
+
+	return 0;
+}
+
+// Test fixture for file-backed slabs
+class SlabFileTest : public ::testing::Test {
+    protected:
+	char path[64];
+	int constructed = 0;
+	struct mm_slab_config config = {};
+
+	void SetUp() override
+	{
+		snprintf(path, sizeof(path), "/tmp/test_slab_file.%d", getpid());
+		unlink(path);
+
+		config.alignment = 16;
+		config.esize = sizeof(struct node);
+		config.ecount = 100;
+		config.ctor = node_ctor;
+		config.ctx = &constructed;
+		config.path = path;
+	}
+
+	void TearDown() override
+	{
+		unlink(path);
+	}
+};
+
+TEST_F(SlabFileTest, Reattach)
+{
+	struct mm_slab *slab = mm_slab_create_config(&config);
+	struct node *head, *n;
+	ssize_t idx = -1;
+	size_t count = 0;
+
+	ASSERT_NE(slab, nullptr);
+	EXPECT_EQ(constructed, 100);
+
+	// Build a list linked by index
+	for (int i = 0; i < 10; i++) {
+		n = (struct node *)mm_slab_alloc(slab);
+		ASSERT_NE(n, nullptr);
+		n->value = i;
+		n->next = idx;
+		idx = mm_slab_index(slab, n);
+		ASSERT_GE(idx, 0);
+	}
+
+	// The file is owned by a single pool at a time
+	EXPECT_EQ(mm_slab_create_config(&config), nullptr);
+
+	// Live objects are kept in the file
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+
+	slab = mm_slab_create_config(&config);
+	ASSERT_NE(slab, nullptr);
+	EXPECT_EQ(constructed, 100);
+
+	EXPECT_EQ(mm_slab_foreach(slab, node_count, &count), 0);
+	EXPECT_EQ(count, 10);
+
+	head = (struct node *)mm_slab_ptr(slab, idx);
+	ASSERT_NE(head, nullptr);
+	for (int i = 9; i >= 0; i--) {
+		ASSERT_NE(head, nullptr);
+		EXPECT_EQ(head->value, i);
+		head = head->next < 0 ? nullptr : (struct node *)mm_slab_ptr(slab, head->next);
+	}
+	EXPECT_EQ(head, nullptr);
+
+	// Reattached objects can be freed, the free slots reused
+	EXPECT_EQ(mm_slab_free(slab, mm_slab_ptr(slab, idx)), 0);
+	EXPECT_NE(mm_slab_alloc(slab), nullptr);
+
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
+TEST_F(SlabFileTest, Mismatch)
+{
+	struct mm_slab *slab = mm_slab_create_config(&config);
+
+	ASSERT_NE(slab, nullptr);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+
+	// Another geometry is not mixed up with the stored pool
+	config.ecount = 50;
+	EXPECT_EQ(mm_slab_create_config(&config), nullptr);
+
+	config.ecount = 100;
+	config.esize = 2 * sizeof(struct node);
+	EXPECT_EQ(mm_slab_create_config(&config), nullptr);
+}
+
+TEST_F(SlabFileTest, Index)
+{
+	struct mm_slab *slab = mm_slab_create_config(&config);
+	void *obj;
+
+	ASSERT_NE(slab, nullptr);
+
+	obj = mm_slab_alloc(slab);
+	ASSERT_NE(obj, nullptr);
+	EXPECT_EQ(mm_slab_ptr(slab, mm_slab_index(slab, obj)), obj);
+	EXPECT_LT(mm_slab_index(slab, (char *)obj + 1), 0);
+	EXPECT_LT(mm_slab_index(slab, &config), 0);
+	EXPECT_EQ(mm_slab_ptr(slab, 100), nullptr);
+
+	EXPECT_EQ(mm_slab_inuse(slab, obj), 1);
+	EXPECT_LT(mm_slab_inuse(slab, &config), 0);
+	EXPECT_EQ(mm_slab_free(slab, obj), 0);
+	EXPECT_EQ(mm_slab_inuse(slab, obj), 0);
+
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -128,6 +128,41 @@ TEST_F(SlabTest, SlabStats)
 	EXPECT_EQ(freed, 1);
 }
 
+// Pointer to element conversion for power of two and odd element sizes
+TEST(SlabIndexTest, FreeEveryElement)
+{
+	const size_t sizes[] = { 1, 3, 24, 64, 100, 1000, 4096, 65537 };
+
+	for (size_t esize : sizes) {
+		struct mm_slab *slab = mm_slab_create(nullptr, 0, esize, 70);
+		ASSERT_NE(slab, nullptr);
+
+		void *ptrs[70];
+		ASSERT_EQ(mm_slab_alloc_bulk(slab, ptrs, 70), 70);
+
+		uint8_t *first = (uint8_t *)ptrs[0];
+		for (int i = 0; i < 70; i++)
+			EXPECT_EQ((uint8_t *)ptrs[i], first + i * esize);
+
+		// Misaligned and out of range pointers are rejected
+		if (esize > 1) {
+			EXPECT_EQ(mm_slab_free(slab, first + 1), -EINVAL);
+			EXPECT_EQ(mm_slab_free(slab, first + 69 * esize + esize - 1), -EINVAL);
+		}
+		EXPECT_EQ(mm_slab_free(slab, first + 70 * esize), -ERANGE);
+		EXPECT_EQ(mm_slab_free(slab, first - esize), -ERANGE);
+
+		// Free from the end, each element gets back to its own slot
+		for (int i = 69; i >= 0; i -= 3) {
+			EXPECT_EQ(mm_slab_free(slab, ptrs[i]), 0);
+			EXPECT_EQ(mm_slab_alloc(slab), ptrs[i]);
+		}
+
+		EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 70), 0);
+		EXPECT_EQ(mm_slab_destroy(slab), 0);
+	}
+}
+
 int main(int argc, char **argv)
 {
 	::testing::InitGoogleTest(&argc, argv);
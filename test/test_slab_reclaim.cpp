@@ -0,0 +1,121 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <unistd.h>
+
+#include <mm/page.h>
+#include <mm/slab.h>
+#include <mm/slab_reclaim.h>
+
+#define ESIZE 256
+#define ECOUNT 1024
+
+// Test fixture for slab memory reclaim
+class SlabReclaimTest : public ::testing::Test {
+    protected:
+	struct mm_slab *slab = nullptr;
+	void *objs[ECOUNT];
+
+	void SetUp() override
+	{
+		struct mm_slab_config config = {};
+
+		config.alignment = 64;
+		config.esize = ESIZE;
+		config.ecount = ECOUNT;
+		config.flags = MM_SLAB_F_PAGES;
+
+		slab = mm_slab_create_config(&config);
+		ASSERT_NE(slab, nullptr);
+
+		// Fault in the whole pool
+		ASSERT_EQ(mm_slab_alloc_bulk(slab, objs, ECOUNT), ECOUNT);
+		for (int i = 0; i < ECOUNT; i++)
+			memset(objs[i], 0xa5, ESIZE);
+	}
+
+	void TearDown() override
+	{
+		EXPECT_EQ(mm_slab_destroy(slab), 0);
+	}
+};
+
+TEST_F(SlabReclaimTest, Empty)
+{
+	EXPECT_EQ(mm_slab_reclaim(slab, 0), 0);
+
+	EXPECT_EQ(mm_slab_free_bulk(slab, objs, ECOUNT), 0);
+	EXPECT_EQ(mm_slab_reclaim(slab, 0), ESIZE * ECOUNT);
+
+	// Already given back
+	EXPECT_EQ(mm_slab_reclaim(slab, 0), 0);
+
+	// Pages come back on use
+	objs[0] = mm_slab_alloc(slab);
+	ASSERT_NE(objs[0], nullptr);
+	memset(objs[0], 0xa5, ESIZE);
+	EXPECT_EQ(mm_slab_free(slab, objs[0]), 0);
+	EXPECT_EQ(mm_slab_reclaim(slab, 0), mm_page_size());
+}
+
+TEST_F(SlabReclaimTest, LiveElements)
+{
+	size_t page = mm_page_size();
+	size_t per_page = page / ESIZE;
+
+	// Keep one element every other page
+	for (size_t i = 0; i < ECOUNT; i++) {
+		if (i % (2 * per_page)) {
+			EXPECT_EQ(mm_slab_free(slab, objs[i]), 0);
+		}
+	}
+
+	EXPECT_EQ(mm_slab_reclaim(slab, 0), ESIZE * ECOUNT / 2);
+
+	for (size_t i = 0; i < ECOUNT; i += 2 * per_page) {
+		EXPECT_EQ(((unsigned char *)objs[i])[ESIZE - 1], 0xa5);
+		EXPECT_EQ(mm_slab_free(slab, objs[i]), 0);
+	}
+}
+
+TEST_F(SlabReclaimTest, Limit)
+{
+	size_t page = mm_page_size();
+
+	EXPECT_EQ(mm_slab_free_bulk(slab, objs, ECOUNT), 0);
+
+	EXPECT_EQ(mm_slab_reclaim(slab, 3 * page), 3 * page);
+	EXPECT_EQ(mm_slab_reclaim(slab, 1), page);
+	EXPECT_EQ(mm_slab_reclaim(slab, 0), ESIZE * ECOUNT - 4 * page);
+}
+
+TEST_F(SlabReclaimTest, Background)
+{
+	struct mm_slab_reclaimer *reclaimer;
+	size_t page = mm_page_size();
+	ssize_t bytes;
+
+	EXPECT_EQ(mm_slab_reclaimer_start(nullptr, 1, 1, page), nullptr);
+
+	reclaimer = mm_slab_reclaimer_start(&slab, 1, 1, page);
+	ASSERT_NE(reclaimer, nullptr);
+
+	EXPECT_EQ(mm_slab_free_bulk(slab, objs, ECOUNT), 0);
+
+	// One page per period
+	for (int i = 0; i < 5000 && mm_slab_reclaimer_bytes(reclaimer) < ESIZE * ECOUNT; i++)
+		usleep(1000);
+
+	bytes = mm_slab_reclaimer_stop(reclaimer);
+	EXPECT_EQ(bytes, ESIZE * ECOUNT);
+	EXPECT_EQ(mm_slab_reclaim(slab, 0), 0);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -3,7 +3,9 @@
 
 #include <gtest/gtest.h>
 
+#include <mm/alloc.h>
 #include <mm/slab.h> // Include the header for the functions you want to test
+#include <mm/track.h>
 
 uint8_t _buffer[128 * 10] __attribute__((aligned(16)));
 
@@ -96,6 +98,101 @@ TEST_F(SlabTest, SlabStats)
 	EXPECT_EQ(freed, 1);
 }
 
+static struct mm_slab_storage _storage;
+static uint8_t _pool[MM_SLAB_BITMAP_SIZE(100) + 64 * 100 + 64];
+static uint8_t _whole[MM_SLAB_BUFFER_SIZE(16, 64, 100)];
+
+// Test case for mm_slab_init with a caller-provided descriptor
+TEST(SlabInitTest, WithStorage)
+{
+	struct mm_slab_config config = {};
+	void *ptrs[100];
+
+	config.buffer = _pool;
+	config.size = sizeof(_pool);
+	config.alignment = 64;
+	config.esize = 64;
+	config.ecount = 100;
+
+	mm_mt_activate();
+	struct mm_malloc_info before = mm_malloc_info();
+
+	struct mm_slab *slab = mm_slab_init(&_storage, &config);
+	ASSERT_EQ((void *)slab, (void *)&_storage);
+
+	EXPECT_EQ(mm_slab_alloc_bulk(slab, ptrs, 100), 100);
+	EXPECT_EQ(mm_slab_alloc(slab), nullptr);
+	for (int i = 0; i < 100; i++) {
+		EXPECT_GE((uintptr_t)ptrs[i], (uintptr_t)_pool);
+		EXPECT_LE((uintptr_t)ptrs[i] + 64, (uintptr_t)_pool + sizeof(_pool));
+		EXPECT_EQ((uintptr_t)ptrs[i] % 64, 0);
+	}
+	EXPECT_EQ(mm_slab_destroy(slab), -EAGAIN);
+	EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 100), 0);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+
+	// No heap at all
+	struct mm_malloc_info after = mm_malloc_info();
+	EXPECT_EQ(after.ucount, before.ucount);
+	EXPECT_EQ(after.umaxallocated, before.umaxallocated);
+	mm_mt_deactivate();
+
+	// The storage can be reused once destroyed
+	slab = mm_slab_init(&_storage, &config);
+	ASSERT_NE(slab, nullptr);
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+	EXPECT_EQ(mm_slab_destroy(slab), -EIO);
+}
+
+// Test case for mm_slab_init with everything in the buffer
+TEST(SlabInitTest, WholeBuffer)
+{
+	struct mm_slab_config config = {};
+
+	config.buffer = _whole;
+	config.size = sizeof(_whole);
+	config.alignment = 16;
+	config.esize = 64;
+	config.ecount = 100;
+
+	struct mm_slab *slab = mm_slab_init(nullptr, &config);
+	ASSERT_NE(slab, nullptr);
+	EXPECT_GE((uintptr_t)slab, (uintptr_t)_whole);
+	EXPECT_LT((uintptr_t)slab, (uintptr_t)_whole + sizeof(_whole));
+
+	for (int round = 0; round < 2; round++) {
+		void *ptrs[100];
+
+		EXPECT_EQ(mm_slab_alloc_bulk(slab, ptrs, 100), 100);
+		for (int i = 0; i < 100; i++) {
+			EXPECT_GT((uintptr_t)ptrs[i], (uintptr_t)slab);
+			EXPECT_LE((uintptr_t)ptrs[i] + 64, (uintptr_t)_whole + sizeof(_whole));
+			memset(ptrs[i], 0xff, 64);
+		}
+		EXPECT_EQ(mm_slab_free_bulk(slab, ptrs, 100), 0);
+	}
+
+	EXPECT_EQ(mm_slab_destroy(slab), 0);
+}
+
+TEST(SlabInitTest, Invalid)
+{
+	struct mm_slab_config config = {};
+
+	config.esize = 64;
+	config.ecount = 100;
+	EXPECT_EQ(mm_slab_init(&_storage, nullptr), nullptr);
+	EXPECT_EQ(mm_slab_init(&_storage, &config), nullptr);
+
+	// Too small to hold the bitmap and the elements
+	config.buffer = _pool;
+	config.size = 64 * 100;
+	EXPECT_EQ(mm_slab_init(&_storage, &config), nullptr);
+
+	config.size = sizeof(_pool);
+	EXPECT_EQ(mm_slab_init(nullptr, &config), nullptr);
+}
+
 int main(int argc, char **argv)
 {
 	::testing::InitGoogleTest(&argc, argv);
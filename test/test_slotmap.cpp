@@ -0,0 +1,139 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+#include <gtest/gtest.h>
+
+#include <mm/slotmap.h>
+
+struct node {
+	uint32_t left;
+	uint32_t right;
+	uint64_t value;
+};
+
+// Test fixture for slot maps
+class SlotmapTest : public ::testing::Test {
+    protected:
+	struct mm_slotmap_config config = {};
+
+	void SetUp() override
+	{
+		config.slab.esize = sizeof(struct node);
+		config.slab.ecount = 1000;
+	}
+};
+
+TEST_F(SlotmapTest, Create)
+{
+	struct mm_slotmap *map;
+
+	EXPECT_EQ(mm_slotmap_create(nullptr), nullptr);
+
+	config.handle_bits = 16;
+	EXPECT_EQ(mm_slotmap_create(&config), nullptr);
+
+	// No room left for generations
+	config.handle_bits = 32;
+	config.slab.ecount = 1u << 31;
+	EXPECT_EQ(mm_slotmap_create(&config), nullptr);
+
+	config.slab.ecount = 1000;
+	map = mm_slotmap_create(&config);
+	ASSERT_NE(map, nullptr);
+	EXPECT_NE(mm_slotmap_slab(map), nullptr);
+	EXPECT_EQ(mm_slotmap_destroy(map), 0);
+}
+
+TEST_F(SlotmapTest, AllocGetFree)
+{
+	struct mm_slotmap *map = mm_slotmap_create(&config);
+	mm_slotmap_handle_t handles[1000];
+	struct node *n;
+
+	ASSERT_NE(map, nullptr);
+	EXPECT_EQ(mm_slotmap_get(map, 0), nullptr);
+
+	for (int i = 0; i < 1000; i++) {
+		n = (struct node *)mm_slotmap_alloc(map, &handles[i]);
+		ASSERT_NE(n, nullptr);
+		EXPECT_NE(handles[i], 0);
+		n->value = i;
+	}
+	EXPECT_EQ(mm_slotmap_alloc(map, &handles[0]), nullptr);
+
+	for (int i = 0; i < 1000; i++) {
+		n = (struct node *)mm_slotmap_get(map, handles[i]);
+		ASSERT_NE(n, nullptr);
+		EXPECT_EQ(n->value, i);
+		EXPECT_EQ(mm_slotmap_handle(map, n), handles[i]);
+	}
+
+	EXPECT_EQ(mm_slotmap_destroy(map), -EAGAIN);
+
+	for (int i = 0; i < 1000; i++)
+		EXPECT_EQ(mm_slotmap_free(map, handles[i]), 0);
+
+	EXPECT_EQ(mm_slotmap_destroy(map), 0);
+}
+
+TEST_F(SlotmapTest, Stale)
+{
+	struct mm_slotmap *map = mm_slotmap_create(&config);
+	mm_slotmap_handle_t old, h;
+	void *obj, *reused;
+
+	ASSERT_NE(map, nullptr);
+
+	obj = mm_slotmap_alloc(map, &old);
+	ASSERT_NE(obj, nullptr);
+	EXPECT_EQ(mm_slotmap_free(map, old), 0);
+
+	// Freed object
+	EXPECT_EQ(mm_slotmap_get(map, old), nullptr);
+	EXPECT_EQ(mm_slotmap_handle(map, obj), 0);
+	EXPECT_EQ(mm_slotmap_free(map, old), -ESTALE);
+
+	// Same slot, new generation
+	reused = mm_slotmap_alloc(map, &h);
+	EXPECT_EQ(reused, obj);
+	EXPECT_NE(h, old);
+	EXPECT_EQ(mm_slotmap_get(map, old), nullptr);
+	EXPECT_EQ(mm_slotmap_get(map, h), reused);
+
+	// Index out of the pool
+	EXPECT_EQ(mm_slotmap_get(map, 1023), nullptr);
+	EXPECT_EQ(mm_slotmap_free(map, 1023), -EINVAL);
+
+	EXPECT_EQ(mm_slotmap_free(map, h), 0);
+	EXPECT_EQ(mm_slotmap_destroy(map), 0);
+}
+
+TEST_F(SlotmapTest, Compact)
+{
+	struct mm_slotmap *map;
+	mm_slotmap_handle_t h, first;
+
+	config.handle_bits = 32;
+	map = mm_slotmap_create(&config);
+	ASSERT_NE(map, nullptr);
+
+	ASSERT_NE(mm_slotmap_alloc(map, &first), nullptr);
+	EXPECT_LE(first, UINT32_MAX);
+	EXPECT_EQ(mm_slotmap_free(map, first), 0);
+
+	// 22 generation bits: every handle fits in 32 bits
+	for (int i = 0; i < 100000; i++) {
+		ASSERT_NE(mm_slotmap_alloc(map, &h), nullptr);
+		EXPECT_LE(h, UINT32_MAX);
+		EXPECT_EQ(mm_slotmap_free(map, h), 0);
+	}
+	EXPECT_EQ(mm_slotmap_get(map, first), nullptr);
+
+	EXPECT_EQ(mm_slotmap_destroy(map), 0);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
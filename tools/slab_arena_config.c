@@ -0,0 +1,291 @@
+// SPDX Licence-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: 2025 Laurent Fazio <laurent.fazio@gmail.com>
+
+/*
+ * Generate a struct mm_slab_arena_config table from the sizes an application
+ * allocates, read from a file or the standard input, one entry per line:
+ *
+ *   <size> <count>         histogram: <count> objects of <size> bytes
+ *   + <size>, - <size>     trace: an allocation, a release of <size> bytes,
+ *                          the peak number of live objects per size is used
+ *   'mem': [ <ptr>, <size> ]
+ *                          live allocation of a verbose mm_mt_summary()
+ *
+ * Empty lines and lines starting with '#' are ignored.
+ */
+
+/* --------------------------------------------------------------------------
+ * HEADERS
+ * -------------------------------------------------------------------------- */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <mm/alloc.h>
+#include <mm/slab_arena.h>
+
+/* --------------------------------------------------------------------------
+ * LOCAL CONSTANTS
+ * -------------------------------------------------------------------------- */
+
+#define DEFAULT_BUDGET (16ul << 20)
+#define DEFAULT_MISS 0.01
+#define DEFAULT_CLASSES 8
+
+/* --------------------------------------------------------------------------
+ * LOCAL TYPES
+ * -------------------------------------------------------------------------- */
+
+struct _size {
+	size_t size;
+	size_t count; /* Histogram count, or peak of live objects */
+	size_t live;
+};
+
+struct _sizes {
+	struct _size *entry;
+	size_t n;
+	size_t max;
+};
+
+/* --------------------------------------------------------------------------
+ * LOCAL FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+static void _usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-b budget[k|m|g]] [-m miss] [-c classes] [-n name] [file]\n"
+		"  -b  memory budget of the pools (default %lu)\n"
+		"  -m  largest share of objects left to the heap, 0 to 1 (default %.2f)\n"
+		"  -c  largest number of classes (default %d)\n"
+		"  -n  name of the generated table (default _sarena_config)\n",
+		name, DEFAULT_BUDGET, DEFAULT_MISS, DEFAULT_CLASSES);
+}
+
+/* Entry of @a size, inserted in order if missing */
+static struct _size *_sizes_get(struct _sizes *sizes, size_t size)
+{
+	size_t lo = 0, hi = sizes->n;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (sizes->entry[mid].size < size)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < sizes->n && sizes->entry[lo].size == size)
+		return &sizes->entry[lo];
+
+	if (sizes->n == sizes->max) {
+		size_t max = sizes->max ? 2 * sizes->max : 64;
+		struct _size *entry = mm_realloc(sizes->entry, max * sizeof(struct _size));
+
+		if (!entry)
+			return NULL;
+
+		sizes->entry = entry;
+		sizes->max = max;
+	}
+
+	memmove(&sizes->entry[lo + 1], &sizes->entry[lo], (sizes->n - lo) * sizeof(struct _size));
+	memset(&sizes->entry[lo], 0, sizeof(struct _size));
+	sizes->entry[lo].size = size;
+	sizes->n++;
+
+	return &sizes->entry[lo];
+}
+
+static int _parse_line(struct _sizes *sizes, const char *line)
+{
+	struct _size *e;
+	const char *mem;
+	size_t size, count;
+	char op;
+
+	while (*line == ' ' || *line == '\t')
+		line++;
+
+	if (!*line || *line == '\n' || *line == '#')
+		return 0;
+
+	mem = strstr(line, "'mem':");
+	if (mem) {
+		const char *comma = strchr(mem, ',');
+
+		if (!comma || sscanf(comma + 1, "%zu", &size) != 1)
+			return -EINVAL;
+
+		e = _sizes_get(sizes, size);
+		if (!e)
+			return -ENOMEM;
+
+		e->count++;
+		return 0;
+	}
+
+	if (sscanf(line, "%c %zu", &op, &size) == 2 && (op == '+' || op == '-')) {
+		e = _sizes_get(sizes, size);
+		if (!e)
+			return -ENOMEM;
+
+		if (op == '-') {
+			if (e->live)
+				e->live--;
+			return 0;
+		}
+
+		if (++e->live > e->count)
+			e->count = e->live;
+		return 0;
+	}
+
+	if (sscanf(line, "%zu %zu", &size, &count) == 2) {
+		e = _sizes_get(sizes, size);
+		if (!e)
+			return -ENOMEM;
+
+		e->count += count;
+		return 0;
+	}
+
+	/* Other lines of a mm_mt_summary() output */
+	return strchr("{}]'", line[0]) ? 0 : -EINVAL;
+}
+
+static int _parse_budget(const char *str, size_t *budget)
+{
+	char *end;
+	unsigned long long v;
+
+	errno = 0;
+	v = strtoull(str, &end, 0);
+	if (errno || end == str)
+		return -EINVAL;
+
+	switch (*end) {
+	case 'g': case 'G':
+		v <<= 10;
+		/* Fallthrough */
+	case 'm': case 'M':
+		v <<= 10;
+		/* Fallthrough */
+	case 'k': case 'K':
+		v <<= 10;
+		end++;
+		break;
+	default:
+		break;
+	}
+
+	if (*end || !v)
+		return -EINVAL;
+
+	*budget = v;
+
+	return 0;
+}
+
+/* --------------------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+	struct mm_slab_arena_config *config;
+	struct mm_slab_arena_size *hist;
+	struct _sizes sizes = { 0 };
+	size_t budget = DEFAULT_BUDGET, classes = DEFAULT_CLASSES, count, i, total = 0, footprint = 0;
+	const char *name = "_sarena_config";
+	double miss = DEFAULT_MISS;
+	char line[512];
+	FILE *in = stdin;
+	int opt, err, lineno = 0;
+
+	while ((opt = getopt(argc, argv, "b:m:c:n:h")) != -1) {
+		switch (opt) {
+		case 'b':
+			if (_parse_budget(optarg, &budget) < 0) {
+				_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'm':
+			miss = strtod(optarg, NULL);
+			break;
+		case 'c':
+			classes = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			name = optarg;
+			break;
+		default:
+			_usage(argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	if (optind < argc) {
+		in = fopen(argv[optind], "r");
+		if (!in) {
+			perror(argv[optind]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	while (fgets(line, sizeof(line), in)) {
+		lineno++;
+		err = _parse_line(&sizes, line);
+		if (err == -EINVAL) {
+			fprintf(stderr, "line %d: cannot parse '%.*s'\n", lineno, (int)strcspn(line, "\n"), line);
+		} else if (err < 0) {
+			fprintf(stderr, "%s\n", strerror(-err));
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (in != stdin)
+		fclose(in);
+
+	hist = mm_calloc(sizes.n ? sizes.n : 1, sizeof(struct mm_slab_arena_size));
+	if (!hist) {
+		fprintf(stderr, "%s\n", strerror(ENOMEM));
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < sizes.n; i++) {
+		hist[i].size = sizes.entry[i].size;
+		hist[i].count = sizes.entry[i].count;
+		total += hist[i].count;
+	}
+
+	err = mm_slab_arena_plan(hist, sizes.n, budget, miss, classes, &config, &count);
+	if (err < 0) {
+		fprintf(stderr, "cannot generate a configuration: %s\n",
+			err == -ENOSPC ? "budget too small for the miss rate" : strerror(-err));
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < count; i++) {
+		footprint += config[i].esize * config[i].ecount;
+		total -= config[i].ecount;
+	}
+
+	printf("/* %zu bytes, %zu object(s) left to the heap */\n", footprint, total);
+	printf("struct mm_slab_arena_config %s[%zu] = {\n", name, count);
+	for (i = 0; i < count; i++)
+		printf("\t{ %zu, %zu },\n", config[i].esize, config[i].ecount);
+	printf("};\n");
+
+	mm_free(config);
+	mm_free(hist);
+	mm_free(sizes.entry);
+
+	return EXIT_SUCCESS;
+}